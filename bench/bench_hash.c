@@ -0,0 +1,258 @@
+/**
+ * @file   bench_hash.c
+ *
+ * @brief  Hash benchmark.
+ *
+ * Measures hash throughput over input lengths and alignments, short
+ * key latency, and key set access patterns. Results are printed as
+ * CSV to stdout:
+ *
+ *     bench,function,length,align,keyset,value,unit
+ *
+ * Usage:
+ *
+ *     shell> bench_hash [scale]
+ *
+ * "scale" multiplies the amount of work (default 1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined( __x86_64__ )
+#include <x86intrin.h>
+#endif
+
+#include "ag_hash.h"
+
+
+/** Hash function under test. */
+typedef ag_hash_t ( *bench_fn_p )( const void* input, size_t length, ag_hash_t seed );
+
+
+static ag_hash_t bench_64( const void* input, size_t length, ag_hash_t seed )
+{
+    (void)seed;
+    return aghs_64( input, length );
+}
+
+static ag_hash_t bench_64_short( const void* input, size_t length, ag_hash_t seed )
+{
+    return aghs_64_short_with_seed( input, length, seed );
+}
+
+
+static struct
+{
+    const char* name;
+    bench_fn_p  fn;
+} bench_fns[] = {
+    { "aghs_64", bench_64 },
+    { "aghs_64_with_seed", aghs_64_with_seed },
+    { "aghs_64_short_with_seed", bench_64_short },
+    { "aghs_wide_64_with_seed", aghs_wide_64_with_seed },
+    { "aghs_crc_64_with_seed", aghs_crc_64_with_seed },
+};
+
+#define BENCH_FN_CNT ( sizeof( bench_fns ) / sizeof( bench_fns[ 0 ] ) )
+
+
+/** Sink for hash values, prevents optimizing hashing away. */
+static volatile ag_hash_t bench_sink;
+
+static int bench_scale = 1;
+
+
+
+/* ------------------------------------------------------------
+ * Timing:
+ */
+
+static double bench_sec( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * Return time stamp counter, or ns without TSC. TSC ticks at a fixed
+ * reference rate, i.e. ticks are not core cycles, when frequency
+ * scaling or turbo is in use.
+ */
+static uint64_t bench_ticks( void )
+{
+#if defined( __x86_64__ )
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+static const char* bench_ticks_unit( void )
+{
+#if defined( __x86_64__ )
+    return "ticks/hash";
+#else
+    return "ns/hash";
+#endif
+}
+
+
+
+/* ------------------------------------------------------------
+ * Benchmarks:
+ */
+
+/**
+ * Throughput in GB/s over lengths and alignments.
+ */
+static void bench_throughput( const uint8_t* buf )
+{
+    size_t lens[] = { 16, 64, 256, 1024, 4096, 65536, 1048576 };
+    size_t aligns[] = { 0, 1, 3, 4, 7 };
+
+    for ( size_t f = 0; f < BENCH_FN_CNT; f++ ) {
+        for ( size_t l = 0; l < sizeof( lens ) / sizeof( lens[ 0 ] ); l++ ) {
+            for ( size_t a = 0; a < sizeof( aligns ) / sizeof( aligns[ 0 ] ); a++ ) {
+
+                size_t const len = lens[ l ];
+                size_t const iter = (size_t)bench_scale * ( 256 * 1048576 / len );
+                ag_hash_t    h = 0;
+                double       t;
+
+                t = bench_sec();
+                for ( size_t i = 0; i < iter; i++ )
+                    h += bench_fns[ f ].fn( buf + aligns[ a ], len, i );
+                t = bench_sec() - t;
+                bench_sink = h;
+
+                printf( "throughput,%s,%zu,%zu,sequential,%.3f,GB/s\n",
+                        bench_fns[ f ].name,
+                        len,
+                        aligns[ a ],
+                        (double)( iter * len ) / t * 1e-9 );
+            }
+        }
+    }
+}
+
+
+/**
+ * Short key latency in TSC ticks (see bench_ticks()) per hash. Each
+ * hash is seeded with the previous hash, so hashes can not overlap.
+ */
+static void bench_latency( const uint8_t* buf )
+{
+    size_t const iter = (size_t)bench_scale * 1000000;
+
+    for ( size_t f = 0; f < BENCH_FN_CNT; f++ ) {
+        for ( size_t len = 1; len <= 32; len++ ) {
+
+            ag_hash_t h = 0;
+            uint64_t  c;
+
+            c = bench_ticks();
+            for ( size_t i = 0; i < iter; i++ )
+                h = bench_fns[ f ].fn( buf + ( h & 63 ), len, h );
+            c = bench_ticks() - c;
+            bench_sink = h;
+
+            printf( "latency,%s,%zu,0,dependent,%.2f,%s\n",
+                    bench_fns[ f ].name,
+                    len,
+                    (double)c / (double)iter,
+                    bench_ticks_unit() );
+        }
+    }
+}
+
+
+/**
+ * Key set hashing in ns per key. Keys are either consecutive in
+ * memory, or at random locations within a large buffer.
+ */
+static void bench_keyset( const uint8_t* buf, size_t size )
+{
+    size_t const cnt = 1 << 20;
+    size_t       lens[] = { 8, 16, 32, 64 };
+    size_t*      pos;
+
+    pos = malloc( cnt * sizeof( size_t ) );
+
+    for ( size_t k = 0; k < 2; k++ ) {
+
+        const char* keyset = k == 0 ? "sequential" : "random";
+
+        for ( size_t l = 0; l < sizeof( lens ) / sizeof( lens[ 0 ] ); l++ ) {
+
+            size_t const len = lens[ l ];
+
+            srand( 1234 );
+            for ( size_t i = 0; i < cnt; i++ ) {
+                if ( k == 0 )
+                    pos[ i ] = ( i * len ) % ( size - len );
+                else
+                    pos[ i ] = ( ( (size_t)rand() << 16 ) ^ (size_t)rand() ) % ( size - len );
+            }
+
+            for ( size_t f = 0; f < BENCH_FN_CNT; f++ ) {
+
+                ag_hash_t h = 0;
+                double    t;
+
+                t = bench_sec();
+                for ( int r = 0; r < bench_scale; r++ ) {
+                    for ( size_t i = 0; i < cnt; i++ )
+                        h += bench_fns[ f ].fn( buf + pos[ i ], len, 0 );
+                }
+                t = bench_sec() - t;
+                bench_sink = h;
+
+                printf( "keyset,%s,%zu,0,%s,%.3f,ns/key\n",
+                        bench_fns[ f ].name,
+                        len,
+                        keyset,
+                        t / (double)( cnt * (size_t)bench_scale ) * 1e9 );
+            }
+        }
+    }
+
+    free( pos );
+}
+
+
+
+int main( int argc, char** argv )
+{
+    size_t const size = 256 * 1048576;
+    uint8_t*     buf;
+
+    if ( argc > 1 )
+        bench_scale = atoi( argv[ 1 ] ) > 0 ? atoi( argv[ 1 ] ) : 1;
+
+    buf = malloc( size );
+    if ( buf == NULL ) {
+        fprintf( stderr, "bench_hash: out of memory\n" );
+        return 1;
+    }
+
+    for ( size_t i = 0; i < size; i++ )
+        buf[ i ] = (uint8_t)( i * 2654435761U >> 24 );
+
+    printf( "bench,function,length,align,keyset,value,unit\n" );
+
+    bench_throughput( buf );
+    bench_latency( buf );
+    bench_keyset( buf, size );
+
+    free( buf );
+
+    return 0;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file   ag_dheap.c
+ *
+ * @brief  D-ary heap algorithms over containers.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ag_dheap.h"
+
+
+/** Return nth heap data (0-based, after padding). */
+#define agdh_nth( h, nth ) ( ( ( h )->po->data )[ ( h )->off + ( nth ) ] )
+
+/** Parent index of index i. */
+#define agdh_parent( h, i ) ( ( ( i )-1 ) >> ( h )->shift )
+
+/** First child index of index i. */
+#define agdh_child( h, i ) ( ( ( i ) << ( h )->shift ) + 1 )
+
+
+static po_size_t agdh_offset( agdh_t h );
+static void agdh_reserve( agdh_t h, po_size_t cnt );
+static po_d agdh_take( agdh_t h );
+static int agdh_compare( agdh_t h, const po_d a, const po_d b );
+static void agdh_sift_up( agdh_t h, po_size_t i, po_d item );
+static void agdh_sift_down( agdh_t h, po_size_t i, po_d item );
+
+
+
+agdh_t agdh_new( po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity )
+{
+    agdh_t h;
+    h = po_malloc( sizeof( agdh_s ) );
+    agdh_init( h, po, cmp, dir, arity );
+    return h;
+}
+
+
+void agdh_init( agdh_t h, po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity )
+{
+    h->po = po;
+    h->cmp = cmp;
+    h->cnt = 0;
+    h->polar = dir;
+    h->off = 0;
+    if ( arity > AGDH_MAX_ARITY )
+        arity = AGDH_MAX_ARITY;
+    h->shift = 1;
+    while ( ( (po_size_t)1 << h->shift ) < arity )
+        h->shift++;
+}
+
+
+agdh_t agdh_del( agdh_t h )
+{
+    po_free( h );
+    return NULL;
+}
+
+
+po_size_t agdh_arity( agdh_t h )
+{
+    return (po_size_t)1 << h->shift;
+}
+
+
+void agdh_put( agdh_t h, po_d item )
+{
+    agdh_reserve( h, h->cnt + 1 );
+
+    agdh_sift_up( h, h->cnt++, item );
+}
+
+
+po_d agdh_get( agdh_t h )
+{
+    po_d ret;
+
+    if ( agdh_is_empty( h ) )
+        return NULL;
+
+    ret = agdh_take( h );
+
+    /* Postor has only padding and heap items. */
+    h->po->used = h->off + h->cnt;
+
+    return ret;
+}
+
+
+void agdh_ify( agdh_t h )
+{
+    /* Items are after padding (if any). */
+    h->cnt = h->po->used > h->off ? h->po->used - h->off : 0;
+    agdh_reserve( h, h->cnt );
+
+    if ( h->cnt < 2 )
+        return;
+
+    /* Bottom-up from the last parent. */
+    for ( po_size_t i = agdh_parent( h, h->cnt - 1 ) + 1; i-- > 0; )
+        agdh_sift_down( h, i, agdh_nth( h, i ) );
+}
+
+
+void agdh_ify_for_sort( agdh_t h )
+{
+    agdh_inv_polar( h );
+    agdh_ify( h );
+    agdh_inv_polar( h );
+}
+
+
+void agdh_sort( agdh_t h )
+{
+    po_size_t lim;
+
+    lim = h->cnt;
+
+    agdh_inv_polar( h );
+    for ( po_size_t i = 0; i < lim; i++ ) {
+        po_d item = agdh_take( h );
+        agdh_nth( h, h->cnt ) = item;
+    }
+    agdh_inv_polar( h );
+
+    /* Remove padding. */
+    if ( h->off > 0 )
+        memmove( h->po->data, h->po->data + h->off, lim * sizeof( po_d ) );
+    h->po->used = lim;
+    h->off = 0;
+}
+
+
+void agdh_sort_postor( po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity )
+{
+    agdh_s hs;
+    agdh_init( &hs, po, cmp, dir, arity );
+    agdh_ify_for_sort( &hs );
+    agdh_sort( &hs );
+}
+
+
+int agdh_is_empty( agdh_t h )
+{
+    if ( h->cnt > 0 )
+        return 0;
+    else
+        return 1;
+}
+
+
+void agdh_set_polar( agdh_t h, po_pos_t polar )
+{
+    h->polar = polar;
+}
+
+
+void agdh_inv_polar( agdh_t h )
+{
+    h->polar *= -1;
+}
+
+
+po_pos_t agdh_get_polar( agdh_t h )
+{
+    return h->polar;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Return Postor index of root, which aligns the first child group
+ * (and hence all child groups) to AGDH_CACHE_LINE. Children of N
+ * are at off+D*N+1, so off+1 must be at line (or group) boundary.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return Padding slot count.
+ */
+static po_size_t agdh_offset( agdh_t h )
+{
+    po_size_t const line = AGDH_CACHE_LINE / sizeof( po_d );
+    po_size_t const arity = (po_size_t)1 << h->shift;
+    po_size_t const align = arity < line ? arity : line;
+    po_size_t const base = (po_size_t)( (uintptr_t)h->po->data / sizeof( po_d ) ) % align;
+
+    return ( 2 * align - 1 - base ) % align;
+}
+
+
+/**
+ * Reserve Postor storage for "cnt" heap items and padding. Heap items
+ * are moved, if Postor storage has been reallocated and the padding
+ * changes.
+ *
+ * @param h   D-ary Heap.
+ * @param cnt Item count.
+ */
+static void agdh_reserve( agdh_t h, po_size_t cnt )
+{
+    po_size_t off;
+
+    off = agdh_offset( h );
+    while ( h->po->used < off + cnt ) {
+        po_push( h->po, NULL );
+        off = agdh_offset( h );
+    }
+
+    if ( off != h->off ) {
+        memmove( h->po->data + off, h->po->data + h->off, h->cnt * sizeof( po_d ) );
+        h->off = off;
+    }
+}
+
+
+/**
+ * Take root item from non-empty heap. Postor used count is not
+ * updated.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return Root item.
+ */
+static po_d agdh_take( agdh_t h )
+{
+    po_d ret;
+    po_d last;
+
+    ret = agdh_nth( h, 0 );
+    last = agdh_nth( h, --h->cnt );
+
+    if ( h->cnt > 0 )
+        agdh_sift_down( h, 0, last );
+
+    return ret;
+}
+
+
+/**
+ * Compare a to b and adjust the compare function result with heap
+ * polar.
+ *
+ * @param h D-ary Heap.
+ * @param a Reference data.
+ * @param b Compare data.
+ *
+ * @return a > b => 1, a < b => -1, a == b => 0.
+ */
+static int agdh_compare( agdh_t h, const po_d a, const po_d b )
+{
+    return h->polar * h->cmp( a, b );
+}
+
+
+/**
+ * Move parents down from index i until proper place for item is
+ * found towards root.
+ *
+ * @param h    D-ary Heap.
+ * @param i    Index of hole.
+ * @param item Item to place.
+ */
+static void agdh_sift_up( agdh_t h, po_size_t i, po_d item )
+{
+    po_size_t parent;
+
+    while ( i > 0 ) {
+        parent = agdh_parent( h, i );
+        if ( agdh_compare( h, agdh_nth( h, parent ), item ) <= 0 )
+            break;
+        agdh_nth( h, i ) = agdh_nth( h, parent );
+        i = parent;
+    }
+
+    agdh_nth( h, i ) = item;
+}
+
+
+/**
+ * Move the smallest child up from index i until the item fits to the
+ * hole.
+ *
+ * @param h    D-ary Heap.
+ * @param i    Index of hole.
+ * @param item Item to place.
+ */
+static void agdh_sift_down( agdh_t h, po_size_t i, po_d item )
+{
+    po_size_t const arity = (po_size_t)1 << h->shift;
+    po_size_t       child;
+    po_size_t       last;
+    po_size_t       best;
+
+    while ( ( child = agdh_child( h, i ) ) < h->cnt ) {
+
+        /* Find the smallest of the (contiguous) children. */
+        last = child + arity < h->cnt ? child + arity : h->cnt;
+        best = child;
+        for ( child++; child < last; child++ ) {
+            if ( agdh_compare( h, agdh_nth( h, child ), agdh_nth( h, best ) ) < 0 )
+                best = child;
+        }
+
+        if ( agdh_compare( h, item, agdh_nth( h, best ) ) <= 0 )
+            break;
+
+        agdh_nth( h, i ) = agdh_nth( h, best );
+        i = best;
+    }
+
+    agdh_nth( h, i ) = item;
+}
@@ -0,0 +1,242 @@
+#ifndef AG_DHEAP_H
+#define AG_DHEAP_H
+
+/**
+ * @file   ag_dheap.h
+ *
+ * @brief  D-ary heap algorithms over containers.
+ *
+ *
+ * D-ary Heap is a sibling of (binary) Heap, see ag_heap.h. Each item
+ * has "arity" number of children, which are stored next to each
+ * other. The tree is shallower than a binary tree, hence a large heap
+ * has fewer cache misses per operation. A larger arity means more
+ * compares per level.
+ *
+ * Items are in array folded from top to bottom, left to right,
+ * starting from heap index 0. For arity D, the children of item at
+ * index N are at D*N+1 ... D*N+D, and the parent is at (N-1)/D.
+ *
+ * The heap is placed in Postor after a few padding slots, so that
+ * every group of children starts at AGDH_CACHE_LINE boundary. With
+ * 8-byte Postor items, a 4-ary node's children fill half a cache
+ * line, and an 8-ary node's children fill exactly one line. The
+ * padding is recalculated when Postor storage is reallocated by
+ * agdh_put(), and it is removed by agdh_sort(). Postor used count
+ * covers the padding and the heap items, i.e. the Postor data is not
+ * directly a heap array, but sorting works as in Heap. A new heap
+ * handle assumes that the Postor has no padding.
+ *
+ * Example of min-at-root 4-ary heap:
+ *
+ *
+ *                    13                     Layer 1
+ *          /     /       \      \
+ *        14    16         19     21         Layer 2
+ *      / | \                 
+ *    65 26 32 ...                           Layer 3
+ *
+ *
+ *             | L1 | L2          | L3
+ *             +----+-------------+-------------
+ *        Idx: | 0  | 1  2  3  4  | 5  6  7 ...
+ *       Item: | 13 | 14 16 19 21 | 65 26 32 ...
+ *
+ * Polarity, heapify and sorting work as in Heap.
+ *
+ */
+
+
+#include <postor.h>
+
+
+/** Maximum D-ary Heap arity. */
+#define AGDH_MAX_ARITY 64
+
+
+#ifndef AGDH_CACHE_LINE
+/** Cache line size (bytes) for child group alignment. */
+#define AGDH_CACHE_LINE 64
+#endif
+
+
+/**
+ * D-ary Heap struct.
+ */
+struct agdh_s
+{
+    po_t            po;    /**< Postor. */
+    po_compare_fn_p cmp;   /**< Compare function. */
+    po_size_t       cnt;   /**< Heap item count. */
+    po_pos_t        polar; /**< Polarity of heap (sm=1,gr=-1). */
+    po_size_t       shift; /**< Arity as power of two. */
+    po_size_t       off;   /**< Postor index of root (padding). */
+};
+
+/** Short type for D-ary Heap struct. */
+typedef struct agdh_s agdh_s;
+
+/** Handle type for D-ary Heap. */
+typedef struct agdh_s* agdh_t;
+
+
+
+/**
+ * Create D-ary Heap handle from Postor.
+ *
+ * Arity is rounded up to the next power of two, and limited to range
+ * 2 ... AGDH_MAX_ARITY. See aghp_new() for the other parameters.
+ *
+ * @param po    Postor.
+ * @param cmp   Data compare function.
+ * @param dir   Polarity (1=ascending).
+ * @param arity Number of children per item.
+ *
+ * @return D-ary Heap.
+ */
+agdh_t agdh_new( po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity );
+
+
+/**
+ * Initialize D-ary Heap handle using Postor.
+ *
+ * See agdh_new() for details about parameters.
+ *
+ * @param h     D-ary Heap.
+ * @param po    Postor.
+ * @param cmp   Data compare function.
+ * @param dir   Polarity.
+ * @param arity Number of children per item.
+ */
+void agdh_init( agdh_t h, po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity );
+
+
+/**
+ * Delete D-ary Heap.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return NULL
+ */
+agdh_t agdh_del( agdh_t h );
+
+
+/**
+ * Return D-ary Heap arity.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return Arity.
+ */
+po_size_t agdh_arity( agdh_t h );
+
+
+/**
+ * Put item to D-ary Heap.
+ *
+ * @param h    D-ary Heap.
+ * @param item Item.
+ */
+void agdh_put( agdh_t h, po_d item );
+
+
+/**
+ * Get item from D-ary Heap.
+ *
+ * Item is either smallest (if polarity is 1) or biggest (if polarity
+ * is -1).
+ *
+ * @param h D-ary Heap.
+ *
+ * @return Item (smallest/biggest), NULL if empty.
+ */
+po_d agdh_get( agdh_t h );
+
+
+/**
+ * Heapify D-ary Heap.
+ *
+ * The assigned Postor items (after padding, if any) are arranged into
+ * d-ary heap (bottom-up, O(n) compares). Padding slots are added to
+ * the front of Postor. Items can be appended to Postor after
+ * agdh_put() and agdh_get() calls, before heapify.
+ *
+ * @param h D-ary Heap.
+ */
+void agdh_ify( agdh_t h );
+
+
+/**
+ * Heapify D-ary Heap for sorting.
+ *
+ * Sorting requires inverted polarity. This is internally arranged and
+ * after this operation agdh_sort() can be called.
+ *
+ * @param h D-ary Heap.
+ */
+void agdh_ify_for_sort( agdh_t h );
+
+
+/**
+ * Sort D-ary Heap.
+ *
+ * Heap must have been heapified with agdh_ify_for_sort(). Sorted
+ * items are at Postor start, and padding slots are removed.
+ *
+ * @param h D-ary Heap.
+ */
+void agdh_sort( agdh_t h );
+
+
+/**
+ * Sort Postor data using D-ary Heap.
+ *
+ * @param po    Postor.
+ * @param cmp   Data compare function.
+ * @param dir   Sort polarity (1 = ascending, -1 = decending).
+ * @param arity Number of children per item.
+ */
+void agdh_sort_postor( po_t po, po_compare_fn_p cmp, po_pos_t dir, po_size_t arity );
+
+
+/**
+ * Return 1 if empty.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return 1 for empty (else 0).
+ */
+int agdh_is_empty( agdh_t h );
+
+
+/**
+ * Set D-ary Heap polarity.
+ *
+ * Polarity: 1 = ascending, -1 = decending.
+ *
+ * @param h     D-ary Heap.
+ * @param polar Polarity.
+ */
+void agdh_set_polar( agdh_t h, po_pos_t polar );
+
+
+/**
+ * Invert D-ary Heap polarity.
+ *
+ * @param h D-ary Heap.
+ */
+void agdh_inv_polar( agdh_t h );
+
+
+/**
+ * Return D-ary Heap polarity.
+ *
+ * @param h D-ary Heap.
+ *
+ * @return Polarity.
+ */
+po_pos_t agdh_get_polar( agdh_t h );
+
+
+
+#endif
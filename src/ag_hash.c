@@ -44,16 +44,28 @@
 
 #include <assert.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined( __x86_64__ )
+#include <immintrin.h>
+#endif
 
 #include "ag_hash.h"
 
 
 #define FORCE_INLINE static
 
+/** Inline regardless of optimization heuristics (batch lanes). */
+#define AGHS_ALWAYS_INLINE static inline __attribute__( ( always_inline ) )
+
 #define AG_HASH_GCC_VERSION ( __GNUC__ * 100 + __GNUC_MINOR__ )
 
 #define aghs_rotl32( x, r ) ( ( x << r ) | ( x >> ( 32 - r ) ) )
-#define aghs_rotl64( x, r ) ( ( x << r ) | ( x >> ( 64 - r ) ) )
 
 
 typedef enum
@@ -161,19 +173,13 @@ FORCE_INLINE ag_hash_t aghs_read_le64_align( const void*    ptr,
                                             : aghs_swap64( *(const ag_hash_t*)ptr );
 }
 
-static const ag_hash_t PRIME64_1 = 11400714785074694791ULL;
-static const ag_hash_t PRIME64_2 = 14029467366897019727ULL;
-static const ag_hash_t PRIME64_3 = 1609587929392839161ULL;
-static const ag_hash_t PRIME64_4 = 9650029242287828579ULL;
-static const ag_hash_t PRIME64_5 = 2870177450012600261ULL;
+static const ag_hash_t PRIME64_1 = AGHS_PRIME64_1;
+static const ag_hash_t PRIME64_2 = AGHS_PRIME64_2;
+static const ag_hash_t PRIME64_3 = AGHS_PRIME64_3;
+static const ag_hash_t PRIME64_4 = AGHS_PRIME64_4;
+static const ag_hash_t PRIME64_5 = AGHS_PRIME64_5;
 
-static ag_hash_t aghs_64_round( ag_hash_t acc, ag_hash_t input )
-{
-    acc += input * PRIME64_2;
-    acc = aghs_rotl64( acc, 31 );
-    acc *= PRIME64_1;
-    return acc;
-}
+/* aghs_64_round() and aghs_64_avalanche() are inlined from header. */
 
 static ag_hash_t aghs_64_merge_round( ag_hash_t acc, ag_hash_t val )
 {
@@ -183,16 +189,6 @@ static ag_hash_t aghs_64_merge_round( ag_hash_t acc, ag_hash_t val )
     return acc;
 }
 
-static ag_hash_t aghs_64_avalanche( ag_hash_t h64 )
-{
-    h64 ^= h64 >> 33;
-    h64 *= PRIME64_2;
-    h64 ^= h64 >> 29;
-    h64 *= PRIME64_3;
-    h64 ^= h64 >> 32;
-    return h64;
-}
-
 
 #define aghs_get64bits( p ) aghs_read_le64_align( p, endian, align )
 
@@ -402,3 +398,1065 @@ ag_hash_t aghs_64( const void* input, size_t len )
 {
     return aghs_64_endian_align( input, len, 0, aghs_little_endian, aghs_unaligned );
 }
+
+
+
+/* ------------------------------------------------------------
+ * Tree section:
+ */
+
+/** Tree hash worker. */
+typedef struct aghs_tree_work_s
+{
+    const uint8_t* input;  /**< Input data. */
+    size_t         length; /**< Input data length. */
+    ag_hash_t      seed;   /**< Hash seed. */
+    ag_hash_t*     leaf;   /**< Leaf hashes. */
+    size_t         first;  /**< First leaf of worker. */
+    size_t         last;   /**< Last leaf of worker (exclusive). */
+} aghs_tree_work_s;
+
+
+static void* aghs_tree_worker( void* arg )
+{
+    aghs_tree_work_s* w = (aghs_tree_work_s*)arg;
+
+    for ( size_t i = w->first; i < w->last; i++ ) {
+        size_t const pos = i * AGHS_TREE_LEAF_SIZE;
+        size_t const len =
+            w->length - pos < AGHS_TREE_LEAF_SIZE ? w->length - pos : AGHS_TREE_LEAF_SIZE;
+        w->leaf[ i ] = aghs_64_with_seed( w->input + pos, len, w->seed );
+    }
+
+    return NULL;
+}
+
+
+ag_hash_t aghs_64_tree( const void* input, size_t len, ag_hash_t seed, int threads )
+{
+    const uint8_t*    p = (const uint8_t*)input;
+    size_t const      leaves = len ? ( len - 1 ) / AGHS_TREE_LEAF_SIZE + 1 : 1;
+    aghs_tree_work_s* work;
+    pthread_t*        tid;
+    int*              started;
+    ag_hash_t*        leaf;
+    ag_hash_t         h64;
+
+    if ( threads < 1 )
+        threads = 1;
+    else if ( (size_t)threads > leaves )
+        threads = (int)leaves;
+
+    leaf = NULL;
+    work = NULL;
+    tid = NULL;
+    started = NULL;
+
+    if ( threads > 1 ) {
+        leaf = po_malloc( leaves * sizeof( ag_hash_t ) );
+        work = po_malloc( (size_t)threads * sizeof( aghs_tree_work_s ) );
+        tid = po_malloc( (size_t)threads * sizeof( pthread_t ) );
+        started = po_malloc( (size_t)threads * sizeof( int ) );
+    }
+
+    if ( leaf == NULL || work == NULL || tid == NULL || started == NULL ) {
+
+        /* Sequential: leaf hashes are streamed directly to root. */
+        aghs_state_s st;
+        aghs_64_init( &st, seed );
+        for ( size_t i = 0; i < leaves; i++ ) {
+            size_t const pos = i * AGHS_TREE_LEAF_SIZE;
+            size_t const n = len - pos < AGHS_TREE_LEAF_SIZE ? len - pos : AGHS_TREE_LEAF_SIZE;
+            h64 = aghs_64_with_seed( p + pos, n, seed );
+            aghs_64_update( &st, &h64, sizeof( h64 ) );
+        }
+        h64 = aghs_64_digest( &st );
+
+    } else {
+
+        for ( int t = 0; t < threads; t++ ) {
+            work[ t ].input = p;
+            work[ t ].length = len;
+            work[ t ].seed = seed;
+            work[ t ].leaf = leaf;
+            work[ t ].first = leaves * (size_t)t / (size_t)threads;
+            work[ t ].last = leaves * (size_t)( t + 1 ) / (size_t)threads;
+        }
+
+        /* Caller works as the first worker. */
+        for ( int t = 1; t < threads; t++ )
+            started[ t ] = pthread_create( &tid[ t ], NULL, aghs_tree_worker, &work[ t ] ) == 0;
+
+        aghs_tree_worker( &work[ 0 ] );
+
+        for ( int t = 1; t < threads; t++ ) {
+            if ( started[ t ] )
+                pthread_join( tid[ t ], NULL );
+            else
+                aghs_tree_worker( &work[ t ] );
+        }
+
+        h64 = aghs_64_with_seed( leaf, leaves * sizeof( ag_hash_t ), seed );
+    }
+
+    po_free( leaf );
+    po_free( work );
+    po_free( tid );
+    po_free( started );
+
+    return h64;
+}
+
+
+
+/* ------------------------------------------------------------
+ * File section:
+ */
+
+/** Read size for files that are not mapped. */
+#define AGHS_FILE_CHUNK ( 256 * 1024 )
+
+
+/**
+ * Hash file by reading it in chunks. Reading starts with pread() from
+ * offset 0, and switches to read() for unseekable files.
+ */
+static int aghs_64_fd_read( int fd, ag_hash_t* hash )
+{
+    aghs_state_s st;
+    uint8_t*     buf;
+    off_t        pos;
+    ssize_t      n;
+    int          seekable;
+
+    buf = po_malloc( AGHS_FILE_CHUNK );
+    if ( buf == NULL ) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    aghs_64_init( &st, 0 );
+    pos = 0;
+    seekable = 1;
+
+    for ( ;; ) {
+        if ( seekable ) {
+            n = pread( fd, buf, AGHS_FILE_CHUNK, pos );
+            if ( n < 0 && errno == ESPIPE && pos == 0 ) {
+                seekable = 0;
+                continue;
+            }
+        } else {
+            n = read( fd, buf, AGHS_FILE_CHUNK );
+        }
+
+        if ( n < 0 && errno == EINTR )
+            continue;
+        if ( n <= 0 )
+            break;
+
+        aghs_64_update( &st, buf, (size_t)n );
+        pos += n;
+    }
+
+    po_free( buf );
+
+    if ( n < 0 )
+        return -1;
+
+    *hash = aghs_64_digest( &st );
+    return 0;
+}
+
+
+int aghs_64_fd( int fd, ag_hash_t* hash )
+{
+    struct stat sb;
+    void*       p;
+
+    if ( fstat( fd, &sb ) < 0 )
+        return -1;
+
+    if ( S_ISREG( sb.st_mode ) && sb.st_size > 0 && (uint64_t)sb.st_size <= SIZE_MAX ) {
+        p = mmap( NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( p != MAP_FAILED ) {
+            madvise( p, (size_t)sb.st_size, MADV_SEQUENTIAL );
+            *hash = aghs_64( p, (size_t)sb.st_size );
+            munmap( p, (size_t)sb.st_size );
+            return 0;
+        }
+    }
+
+    return aghs_64_fd_read( fd, hash );
+}
+
+
+int aghs_64_file( const char* path, ag_hash_t* hash )
+{
+    int fd;
+    int ret;
+    int err;
+
+    do {
+        fd = open( path, O_RDONLY | O_CLOEXEC );
+    } while ( fd < 0 && errno == EINTR );
+
+    if ( fd < 0 )
+        return -1;
+
+    ret = aghs_64_fd( fd, hash );
+
+    err = errno;
+    close( fd );
+    errno = err;
+
+    return ret;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Streaming section:
+ */
+
+void aghs_64_init( aghs_state_t st, ag_hash_t seed )
+{
+    memset( st, 0, sizeof( aghs_state_s ) );
+    st->seed = seed;
+    st->v[ 0 ] = seed + PRIME64_1 + PRIME64_2;
+    st->v[ 1 ] = seed + PRIME64_2;
+    st->v[ 2 ] = seed + 0;
+    st->v[ 3 ] = seed - PRIME64_1;
+}
+
+
+void aghs_64_update( aghs_state_t st, const void* input, size_t len )
+{
+    const aghs_endianess endian = aghs_little_endian;
+    const aghs_alignment align = aghs_unaligned;
+
+    const uint8_t* p = (const uint8_t*)input;
+    const uint8_t* bEnd = p + len;
+
+    if ( input == NULL || len == 0 )
+        return;
+
+    st->total += len;
+
+    /* Not enough for a full stripe, just collect. */
+    if ( st->memsize + len < 32 ) {
+        memcpy( ( (uint8_t*)st->mem ) + st->memsize, input, len );
+        st->memsize += (uint32_t)len;
+        return;
+    }
+
+    /* Complete the buffered stripe first. */
+    if ( st->memsize ) {
+        memcpy( ( (uint8_t*)st->mem ) + st->memsize, input, 32 - st->memsize );
+        st->v[ 0 ] = aghs_64_round( st->v[ 0 ], aghs_get64bits( st->mem + 0 ) );
+        st->v[ 1 ] = aghs_64_round( st->v[ 1 ], aghs_get64bits( st->mem + 1 ) );
+        st->v[ 2 ] = aghs_64_round( st->v[ 2 ], aghs_get64bits( st->mem + 2 ) );
+        st->v[ 3 ] = aghs_64_round( st->v[ 3 ], aghs_get64bits( st->mem + 3 ) );
+        p += 32 - st->memsize;
+        st->memsize = 0;
+    }
+
+    if ( p + 32 <= bEnd ) {
+        const uint8_t* const limit = bEnd - 32;
+        ag_hash_t            v1 = st->v[ 0 ];
+        ag_hash_t            v2 = st->v[ 1 ];
+        ag_hash_t            v3 = st->v[ 2 ];
+        ag_hash_t            v4 = st->v[ 3 ];
+
+        do {
+            v1 = aghs_64_round( v1, aghs_get64bits( p ) );
+            p += 8;
+            v2 = aghs_64_round( v2, aghs_get64bits( p ) );
+            p += 8;
+            v3 = aghs_64_round( v3, aghs_get64bits( p ) );
+            p += 8;
+            v4 = aghs_64_round( v4, aghs_get64bits( p ) );
+            p += 8;
+        } while ( p <= limit );
+
+        st->v[ 0 ] = v1;
+        st->v[ 1 ] = v2;
+        st->v[ 2 ] = v3;
+        st->v[ 3 ] = v4;
+    }
+
+    if ( p < bEnd ) {
+        memcpy( st->mem, p, (size_t)( bEnd - p ) );
+        st->memsize = (uint32_t)( bEnd - p );
+    }
+}
+
+
+ag_hash_t aghs_64_digest( aghs_state_t st )
+{
+    ag_hash_t h64;
+
+    if ( st->total >= 32 ) {
+        ag_hash_t const v1 = st->v[ 0 ];
+        ag_hash_t const v2 = st->v[ 1 ];
+        ag_hash_t const v3 = st->v[ 2 ];
+        ag_hash_t const v4 = st->v[ 3 ];
+
+        h64 = aghs_rotl64( v1, 1 ) + aghs_rotl64( v2, 7 ) + aghs_rotl64( v3, 12 ) +
+              aghs_rotl64( v4, 18 );
+        h64 = aghs_64_merge_round( h64, v1 );
+        h64 = aghs_64_merge_round( h64, v2 );
+        h64 = aghs_64_merge_round( h64, v3 );
+        h64 = aghs_64_merge_round( h64, v4 );
+    } else {
+        h64 = st->seed + PRIME64_5;
+    }
+
+    h64 += st->total;
+
+    return aghs_64_finalize( h64, st->mem, st->memsize, aghs_little_endian, aghs_unaligned );
+}
+
+
+
+/* ------------------------------------------------------------
+ * 128-bit section:
+ *
+ * Low half is the 64-bit hash. High half merges the same four lanes
+ * in different order and rotation, and runs the tail through its own
+ * finalize chain with a different start value. Bulk input is thus
+ * processed only once.
+ */
+
+static ag_hash_t aghs_128_merge_hi( ag_hash_t v1, ag_hash_t v2, ag_hash_t v3, ag_hash_t v4 )
+{
+    ag_hash_t h64;
+
+    h64 = aghs_rotl64( v1, 18 ) + aghs_rotl64( v2, 12 ) + aghs_rotl64( v3, 7 ) +
+          aghs_rotl64( v4, 1 );
+    h64 ^= PRIME64_3;
+    h64 = aghs_64_merge_round( h64, v4 );
+    h64 = aghs_64_merge_round( h64, v3 );
+    h64 = aghs_64_merge_round( h64, v2 );
+    h64 = aghs_64_merge_round( h64, v1 );
+
+    return h64;
+}
+
+
+FORCE_INLINE ag_hash128_t aghs_128_endian_align( const void*    input,
+                                                 size_t         len,
+                                                 ag_hash_t      seed,
+                                                 aghs_endianess endian,
+                                                 aghs_alignment align )
+{
+    const uint8_t* p = (const uint8_t*)input;
+    const uint8_t* bEnd = p + len;
+    ag_hash_t      lo;
+    ag_hash_t      hi;
+    ag_hash128_t   ret;
+
+    if ( p == NULL ) {
+        len = 0;
+        bEnd = p = (const uint8_t*)(size_t)32;
+    }
+
+    if ( len >= 32 ) {
+        const uint8_t* const limit = bEnd - 32;
+        ag_hash_t            v1 = seed + PRIME64_1 + PRIME64_2;
+        ag_hash_t            v2 = seed + PRIME64_2;
+        ag_hash_t            v3 = seed + 0;
+        ag_hash_t            v4 = seed - PRIME64_1;
+
+        do {
+            v1 = aghs_64_round( v1, aghs_get64bits( p ) );
+            p += 8;
+            v2 = aghs_64_round( v2, aghs_get64bits( p ) );
+            p += 8;
+            v3 = aghs_64_round( v3, aghs_get64bits( p ) );
+            p += 8;
+            v4 = aghs_64_round( v4, aghs_get64bits( p ) );
+            p += 8;
+        } while ( p <= limit );
+
+        lo = aghs_rotl64( v1, 1 ) + aghs_rotl64( v2, 7 ) + aghs_rotl64( v3, 12 ) +
+             aghs_rotl64( v4, 18 );
+        lo = aghs_64_merge_round( lo, v1 );
+        lo = aghs_64_merge_round( lo, v2 );
+        lo = aghs_64_merge_round( lo, v3 );
+        lo = aghs_64_merge_round( lo, v4 );
+
+        hi = aghs_128_merge_hi( v1, v2, v3, v4 );
+
+    } else {
+        lo = seed + PRIME64_5;
+        hi = seed + PRIME64_4;
+    }
+
+    lo += (ag_hash_t)len;
+    hi += (ag_hash_t)len;
+
+    ret.lo = aghs_64_finalize( lo, p, len, endian, align );
+    ret.hi = aghs_64_finalize( hi, p, len, endian, align );
+
+    return ret;
+}
+
+
+ag_hash128_t aghs_128_with_seed( const void* input, size_t len, ag_hash_t seed )
+{
+    return aghs_128_endian_align( input, len, seed, aghs_little_endian, aghs_unaligned );
+}
+
+
+ag_hash128_t aghs_128( const void* input, size_t len )
+{
+    return aghs_128_endian_align( input, len, 0, aghs_little_endian, aghs_unaligned );
+}
+
+
+ag_hash128_t aghs_128_digest( aghs_state_t st )
+{
+    ag_hash_t    hi;
+    ag_hash128_t ret;
+
+    if ( st->total >= 32 )
+        hi = aghs_128_merge_hi( st->v[ 0 ], st->v[ 1 ], st->v[ 2 ], st->v[ 3 ] );
+    else
+        hi = st->seed + PRIME64_4;
+
+    hi += st->total;
+
+    ret.lo = aghs_64_digest( st );
+    ret.hi = aghs_64_finalize( hi, st->mem, st->memsize, aghs_little_endian, aghs_unaligned );
+
+    return ret;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Wide hash section:
+ *
+ * Input is processed in 64 byte stripes. Each stripe is accumulated
+ * to eight lanes with a 32x32->64 bit multiply. After every block of
+ * stripes the lanes are scrambled. The last stripe is always the last
+ * 64 bytes of input (possibly overlapping with the previous stripe).
+ *
+ * Lanes are independent of each other except for the pairwise data
+ * swap, which is why the SIMD implementations compute exactly the
+ * same values as the scalar one.
+ */
+
+#define AGHS_WIDE_STRIPE 64
+#define AGHS_WIDE_LANES 8
+#define AGHS_WIDE_BLOCK 16
+
+static const uint32_t PRIME32_1 = 2654435761U;
+
+
+/* Wide hash keys (splitmix64 sequence seeded with PRIME64_1). */
+static const ag_hash_t aghs_wide_key[ 2 * AGHS_WIDE_LANES ] = {
+    0x8c9ff21eb4943e94ULL, 0x529bcfd80991254cULL, 0x12b8eb6d931b5e6eULL, 0xcec50c5d0c1fcc21ULL,
+    0x31f5796e26ef1ca1ULL, 0x6fad0e5ad91dff82ULL, 0x061c22c6f5405433ULL, 0xacebed3be37886a1ULL,
+    0x0d81e8485a2713a6ULL, 0xa3e600f8f1fd238cULL, 0xef1382c779e55f8eULL, 0xfe2c41ff60885d40ULL,
+    0x94cbb826dac34bb2ULL, 0xb502428724a731f6ULL, 0xd0bec29520b72715ULL, 0x81335f7cacfebd80ULL,
+};
+
+
+/** Wide hash lane loop function. */
+typedef void ( *aghs_wide_loop_fn_p )( ag_hash_t*       acc,
+                                       const uint8_t*   p,
+                                       size_t           len,
+                                       const ag_hash_t* key );
+
+
+static void aghs_wide_accumulate_scalar( ag_hash_t* acc, const uint8_t* p, const ag_hash_t* key )
+{
+    for ( int i = 0; i < AGHS_WIDE_LANES; i++ ) {
+        ag_hash_t const d = aghs_read64( p + 8 * i );
+        ag_hash_t const k = d ^ key[ i ];
+        acc[ i ^ 1 ] += d;
+        acc[ i ] += ( k & 0xffffffff ) * ( k >> 32 );
+    }
+}
+
+static void aghs_wide_scramble_scalar( ag_hash_t* acc, const ag_hash_t* key )
+{
+    for ( int i = 0; i < AGHS_WIDE_LANES; i++ ) {
+        ag_hash_t a = acc[ i ];
+        a ^= a >> 47;
+        a ^= key[ i ];
+        acc[ i ] = a * PRIME32_1;
+    }
+}
+
+
+/*
+ * Lane loop over all stripes, parametrized with the accumulate and
+ * scramble functions. Key has accumulate keys in the first half and
+ * scramble keys in the second half. The last stripe uses the scramble
+ * keys for accumulation.
+ */
+#define AGHS_WIDE_LOOP( accumulate, scramble )                                 \
+    {                                                                          \
+        size_t const stripes = ( len - 1 ) / AGHS_WIDE_STRIPE;                 \
+        size_t       s;                                                        \
+                                                                               \
+        for ( s = 0; s + AGHS_WIDE_BLOCK <= stripes; s += AGHS_WIDE_BLOCK ) {  \
+            for ( size_t j = 0; j < AGHS_WIDE_BLOCK; j++ )                     \
+                accumulate( acc, p + ( s + j ) * AGHS_WIDE_STRIPE, key );      \
+            scramble( acc, key + AGHS_WIDE_LANES );                            \
+        }                                                                      \
+                                                                               \
+        for ( ; s < stripes; s++ )                                             \
+            accumulate( acc, p + s * AGHS_WIDE_STRIPE, key );                  \
+                                                                               \
+        accumulate( acc, p + len - AGHS_WIDE_STRIPE, key + AGHS_WIDE_LANES );  \
+    }
+
+
+static void aghs_wide_loop_scalar( ag_hash_t*       acc,
+                                   const uint8_t*   p,
+                                   size_t           len,
+                                   const ag_hash_t* key )
+AGHS_WIDE_LOOP( aghs_wide_accumulate_scalar, aghs_wide_scramble_scalar )
+
+
+#if defined( __x86_64__ )
+
+FORCE_INLINE void aghs_wide_accumulate_sse2( ag_hash_t* acc, const uint8_t* p, const ag_hash_t* key )
+{
+    __m128i* const xacc = (__m128i*)acc;
+
+    for ( int i = 0; i < AGHS_WIDE_LANES / 2; i++ ) {
+        __m128i const d = _mm_loadu_si128( (const __m128i*)p + i );
+        __m128i const k = _mm_xor_si128( d, _mm_loadu_si128( (const __m128i*)key + i ) );
+        __m128i const k_hi = _mm_shuffle_epi32( k, _MM_SHUFFLE( 0, 3, 0, 1 ) );
+        __m128i const d_swap = _mm_shuffle_epi32( d, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+        __m128i       a = _mm_loadu_si128( xacc + i );
+        a = _mm_add_epi64( a, d_swap );
+        a = _mm_add_epi64( a, _mm_mul_epu32( k, k_hi ) );
+        _mm_storeu_si128( xacc + i, a );
+    }
+}
+
+FORCE_INLINE void aghs_wide_scramble_sse2( ag_hash_t* acc, const ag_hash_t* key )
+{
+    __m128i* const xacc = (__m128i*)acc;
+    __m128i const  prime = _mm_set1_epi32( (int)PRIME32_1 );
+
+    for ( int i = 0; i < AGHS_WIDE_LANES / 2; i++ ) {
+        __m128i a = _mm_loadu_si128( xacc + i );
+        a = _mm_xor_si128( a, _mm_srli_epi64( a, 47 ) );
+        a = _mm_xor_si128( a, _mm_loadu_si128( (const __m128i*)key + i ) );
+        __m128i const lo = _mm_mul_epu32( a, prime );
+        __m128i const hi = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), prime );
+        _mm_storeu_si128( xacc + i, _mm_add_epi64( lo, _mm_slli_epi64( hi, 32 ) ) );
+    }
+}
+
+static void aghs_wide_loop_sse2( ag_hash_t*       acc,
+                                 const uint8_t*   p,
+                                 size_t           len,
+                                 const ag_hash_t* key )
+AGHS_WIDE_LOOP( aghs_wide_accumulate_sse2, aghs_wide_scramble_sse2 )
+
+
+#define AGHS_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+
+AGHS_TARGET_AVX2 FORCE_INLINE void aghs_wide_accumulate_avx2( ag_hash_t*       acc,
+                                                              const uint8_t*   p,
+                                                              const ag_hash_t* key )
+{
+    __m256i* const xacc = (__m256i*)acc;
+
+    for ( int i = 0; i < AGHS_WIDE_LANES / 4; i++ ) {
+        __m256i const d = _mm256_loadu_si256( (const __m256i*)p + i );
+        __m256i const k = _mm256_xor_si256( d, _mm256_loadu_si256( (const __m256i*)key + i ) );
+        __m256i const k_hi = _mm256_shuffle_epi32( k, _MM_SHUFFLE( 0, 3, 0, 1 ) );
+        __m256i const d_swap = _mm256_shuffle_epi32( d, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+        __m256i       a = _mm256_loadu_si256( xacc + i );
+        a = _mm256_add_epi64( a, d_swap );
+        a = _mm256_add_epi64( a, _mm256_mul_epu32( k, k_hi ) );
+        _mm256_storeu_si256( xacc + i, a );
+    }
+}
+
+AGHS_TARGET_AVX2 FORCE_INLINE void aghs_wide_scramble_avx2( ag_hash_t* acc, const ag_hash_t* key )
+{
+    __m256i* const xacc = (__m256i*)acc;
+    __m256i const  prime = _mm256_set1_epi32( (int)PRIME32_1 );
+
+    for ( int i = 0; i < AGHS_WIDE_LANES / 4; i++ ) {
+        __m256i a = _mm256_loadu_si256( xacc + i );
+        a = _mm256_xor_si256( a, _mm256_srli_epi64( a, 47 ) );
+        a = _mm256_xor_si256( a, _mm256_loadu_si256( (const __m256i*)key + i ) );
+        __m256i const lo = _mm256_mul_epu32( a, prime );
+        __m256i const hi = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), prime );
+        _mm256_storeu_si256( xacc + i, _mm256_add_epi64( lo, _mm256_slli_epi64( hi, 32 ) ) );
+    }
+}
+
+AGHS_TARGET_AVX2 static void aghs_wide_loop_avx2( ag_hash_t*       acc,
+                                                  const uint8_t*   p,
+                                                  size_t           len,
+                                                  const ag_hash_t* key )
+AGHS_WIDE_LOOP( aghs_wide_accumulate_avx2, aghs_wide_scramble_avx2 )
+
+
+
+#define AGHS_TARGET_AVX512 __attribute__( ( target( "avx512f" ) ) )
+
+AGHS_TARGET_AVX512 FORCE_INLINE void aghs_wide_accumulate_avx512( ag_hash_t*       acc,
+                                                                  const uint8_t*   p,
+                                                                  const ag_hash_t* key )
+{
+    __m512i const d = _mm512_loadu_si512( p );
+    __m512i const k = _mm512_xor_si512( d, _mm512_loadu_si512( key ) );
+    __m512i const k_hi = _mm512_shuffle_epi32( k, (_MM_PERM_ENUM)_MM_SHUFFLE( 0, 3, 0, 1 ) );
+    __m512i const d_swap = _mm512_shuffle_epi32( d, (_MM_PERM_ENUM)_MM_SHUFFLE( 1, 0, 3, 2 ) );
+    __m512i       a = _mm512_loadu_si512( acc );
+    a = _mm512_add_epi64( a, d_swap );
+    a = _mm512_add_epi64( a, _mm512_mul_epu32( k, k_hi ) );
+    _mm512_storeu_si512( acc, a );
+}
+
+AGHS_TARGET_AVX512 FORCE_INLINE void aghs_wide_scramble_avx512( ag_hash_t*       acc,
+                                                                const ag_hash_t* key )
+{
+    __m512i const prime = _mm512_set1_epi32( (int)PRIME32_1 );
+    __m512i       a = _mm512_loadu_si512( acc );
+    a = _mm512_xor_si512( a, _mm512_srli_epi64( a, 47 ) );
+    a = _mm512_xor_si512( a, _mm512_loadu_si512( key ) );
+    __m512i const lo = _mm512_mul_epu32( a, prime );
+    __m512i const hi = _mm512_mul_epu32( _mm512_srli_epi64( a, 32 ), prime );
+    _mm512_storeu_si512( acc, _mm512_add_epi64( lo, _mm512_slli_epi64( hi, 32 ) ) );
+}
+
+AGHS_TARGET_AVX512 static void aghs_wide_loop_avx512( ag_hash_t*       acc,
+                                                      const uint8_t*   p,
+                                                      size_t           len,
+                                                      const ag_hash_t* key )
+AGHS_WIDE_LOOP( aghs_wide_accumulate_avx512, aghs_wide_scramble_avx512 )
+
+#endif
+
+
+/**
+ * Selected wide loop. Accessed atomically, since the first calls may
+ * be concurrent.
+ */
+static aghs_wide_loop_fn_p aghs_wide_loop = NULL;
+
+
+/**
+ * Return 1 if CPU supports the implementation.
+ */
+static int aghs_wide_supported( aghs_wide_impl_t impl )
+{
+#if defined( __x86_64__ )
+    __builtin_cpu_init();
+    switch ( impl ) {
+        case aghs_wide_scalar:
+        case aghs_wide_sse2: return 1;
+        case aghs_wide_avx2: return __builtin_cpu_supports( "avx2" );
+        case aghs_wide_avx512: return __builtin_cpu_supports( "avx512f" );
+        default: return 0;
+    }
+#else
+    return impl == aghs_wide_scalar;
+#endif
+}
+
+
+aghs_wide_impl_t aghs_wide_select( aghs_wide_impl_t impl )
+{
+    aghs_wide_loop_fn_p loop;
+
+    if ( impl == aghs_wide_auto || !aghs_wide_supported( impl ) ) {
+        impl = aghs_wide_avx512;
+        while ( !aghs_wide_supported( impl ) )
+            impl--;
+    }
+
+    switch ( impl ) {
+#if defined( __x86_64__ )
+        case aghs_wide_avx512: loop = aghs_wide_loop_avx512; break;
+        case aghs_wide_avx2: loop = aghs_wide_loop_avx2; break;
+        case aghs_wide_sse2: loop = aghs_wide_loop_sse2; break;
+#endif
+        default: loop = aghs_wide_loop_scalar; break;
+    }
+
+    __atomic_store_n( &aghs_wide_loop, loop, __ATOMIC_RELEASE );
+
+    return impl;
+}
+
+
+ag_hash_t aghs_wide_64_with_seed( const void* input, size_t len, ag_hash_t seed )
+{
+    ag_hash_t acc[ AGHS_WIDE_LANES ] = { PRIME32_1, PRIME64_1, PRIME64_2, PRIME64_3,
+                                         PRIME64_4, PRIME64_5, PRIME64_1 + PRIME64_2,
+                                         PRIME64_2 - PRIME64_1 };
+    ag_hash_t           key[ 2 * AGHS_WIDE_LANES ];
+    ag_hash_t           h64;
+    aghs_wide_loop_fn_p loop;
+
+    if ( len < AGHS_WIDE_STRIPE )
+        return aghs_64_with_seed( input, len, seed );
+
+    loop = __atomic_load_n( &aghs_wide_loop, __ATOMIC_ACQUIRE );
+    if ( loop == NULL ) {
+        aghs_wide_select( aghs_wide_auto );
+        loop = __atomic_load_n( &aghs_wide_loop, __ATOMIC_ACQUIRE );
+    }
+
+    for ( int i = 0; i < 2 * AGHS_WIDE_LANES; i += 2 ) {
+        key[ i ] = aghs_wide_key[ i ] + seed;
+        key[ i + 1 ] = aghs_wide_key[ i + 1 ] - seed;
+    }
+
+    loop( acc, (const uint8_t*)input, len, key );
+
+    h64 = seed + (ag_hash_t)len * PRIME64_1;
+    for ( int i = 0; i < AGHS_WIDE_LANES; i++ )
+        h64 = aghs_64_merge_round( h64, acc[ i ] );
+
+    return aghs_64_avalanche( h64 );
+}
+
+
+ag_hash_t aghs_wide_64( const void* input, size_t len )
+{
+    return aghs_wide_64_with_seed( input, len, 0 );
+}
+
+
+
+/* ------------------------------------------------------------
+ * CRC section:
+ *
+ * Input is processed in 16 byte blocks by two independent CRC32C
+ * chains, one for each 8 byte word, which hides the crc32 latency.
+ * The last 1-15 bytes are read to two words with overlapping loads,
+ * and the second chain mixes in the first word multiplied, so that
+ * short keys affect both chains. Both chains are joined and mixed
+ * with aghs_64_avalanche().
+ */
+
+/* CRC32C (reflected 0x82F63B78) table for portable implementation. */
+static const uint32_t aghs_crc_table[ 256 ] = {
+    0x00000000U, 0xf26b8303U, 0xe13b70f7U, 0x1350f3f4U, 0xc79a971fU, 0x35f1141cU,
+    0x26a1e7e8U, 0xd4ca64ebU, 0x8ad958cfU, 0x78b2dbccU, 0x6be22838U, 0x9989ab3bU,
+    0x4d43cfd0U, 0xbf284cd3U, 0xac78bf27U, 0x5e133c24U, 0x105ec76fU, 0xe235446cU,
+    0xf165b798U, 0x030e349bU, 0xd7c45070U, 0x25afd373U, 0x36ff2087U, 0xc494a384U,
+    0x9a879fa0U, 0x68ec1ca3U, 0x7bbcef57U, 0x89d76c54U, 0x5d1d08bfU, 0xaf768bbcU,
+    0xbc267848U, 0x4e4dfb4bU, 0x20bd8edeU, 0xd2d60dddU, 0xc186fe29U, 0x33ed7d2aU,
+    0xe72719c1U, 0x154c9ac2U, 0x061c6936U, 0xf477ea35U, 0xaa64d611U, 0x580f5512U,
+    0x4b5fa6e6U, 0xb93425e5U, 0x6dfe410eU, 0x9f95c20dU, 0x8cc531f9U, 0x7eaeb2faU,
+    0x30e349b1U, 0xc288cab2U, 0xd1d83946U, 0x23b3ba45U, 0xf779deaeU, 0x05125dadU,
+    0x1642ae59U, 0xe4292d5aU, 0xba3a117eU, 0x4851927dU, 0x5b016189U, 0xa96ae28aU,
+    0x7da08661U, 0x8fcb0562U, 0x9c9bf696U, 0x6ef07595U, 0x417b1dbcU, 0xb3109ebfU,
+    0xa0406d4bU, 0x522bee48U, 0x86e18aa3U, 0x748a09a0U, 0x67dafa54U, 0x95b17957U,
+    0xcba24573U, 0x39c9c670U, 0x2a993584U, 0xd8f2b687U, 0x0c38d26cU, 0xfe53516fU,
+    0xed03a29bU, 0x1f682198U, 0x5125dad3U, 0xa34e59d0U, 0xb01eaa24U, 0x42752927U,
+    0x96bf4dccU, 0x64d4cecfU, 0x77843d3bU, 0x85efbe38U, 0xdbfc821cU, 0x2997011fU,
+    0x3ac7f2ebU, 0xc8ac71e8U, 0x1c661503U, 0xee0d9600U, 0xfd5d65f4U, 0x0f36e6f7U,
+    0x61c69362U, 0x93ad1061U, 0x80fde395U, 0x72966096U, 0xa65c047dU, 0x5437877eU,
+    0x4767748aU, 0xb50cf789U, 0xeb1fcbadU, 0x197448aeU, 0x0a24bb5aU, 0xf84f3859U,
+    0x2c855cb2U, 0xdeeedfb1U, 0xcdbe2c45U, 0x3fd5af46U, 0x7198540dU, 0x83f3d70eU,
+    0x90a324faU, 0x62c8a7f9U, 0xb602c312U, 0x44694011U, 0x5739b3e5U, 0xa55230e6U,
+    0xfb410cc2U, 0x092a8fc1U, 0x1a7a7c35U, 0xe811ff36U, 0x3cdb9bddU, 0xceb018deU,
+    0xdde0eb2aU, 0x2f8b6829U, 0x82f63b78U, 0x709db87bU, 0x63cd4b8fU, 0x91a6c88cU,
+    0x456cac67U, 0xb7072f64U, 0xa457dc90U, 0x563c5f93U, 0x082f63b7U, 0xfa44e0b4U,
+    0xe9141340U, 0x1b7f9043U, 0xcfb5f4a8U, 0x3dde77abU, 0x2e8e845fU, 0xdce5075cU,
+    0x92a8fc17U, 0x60c37f14U, 0x73938ce0U, 0x81f80fe3U, 0x55326b08U, 0xa759e80bU,
+    0xb4091bffU, 0x466298fcU, 0x1871a4d8U, 0xea1a27dbU, 0xf94ad42fU, 0x0b21572cU,
+    0xdfeb33c7U, 0x2d80b0c4U, 0x3ed04330U, 0xccbbc033U, 0xa24bb5a6U, 0x502036a5U,
+    0x4370c551U, 0xb11b4652U, 0x65d122b9U, 0x97baa1baU, 0x84ea524eU, 0x7681d14dU,
+    0x2892ed69U, 0xdaf96e6aU, 0xc9a99d9eU, 0x3bc21e9dU, 0xef087a76U, 0x1d63f975U,
+    0x0e330a81U, 0xfc588982U, 0xb21572c9U, 0x407ef1caU, 0x532e023eU, 0xa145813dU,
+    0x758fe5d6U, 0x87e466d5U, 0x94b49521U, 0x66df1622U, 0x38cc2a06U, 0xcaa7a905U,
+    0xd9f75af1U, 0x2b9cd9f2U, 0xff56bd19U, 0x0d3d3e1aU, 0x1e6dcdeeU, 0xec064eedU,
+    0xc38d26c4U, 0x31e6a5c7U, 0x22b65633U, 0xd0ddd530U, 0x0417b1dbU, 0xf67c32d8U,
+    0xe52cc12cU, 0x1747422fU, 0x49547e0bU, 0xbb3ffd08U, 0xa86f0efcU, 0x5a048dffU,
+    0x8ecee914U, 0x7ca56a17U, 0x6ff599e3U, 0x9d9e1ae0U, 0xd3d3e1abU, 0x21b862a8U,
+    0x32e8915cU, 0xc083125fU, 0x144976b4U, 0xe622f5b7U, 0xf5720643U, 0x07198540U,
+    0x590ab964U, 0xab613a67U, 0xb831c993U, 0x4a5a4a90U, 0x9e902e7bU, 0x6cfbad78U,
+    0x7fab5e8cU, 0x8dc0dd8fU, 0xe330a81aU, 0x115b2b19U, 0x020bd8edU, 0xf0605beeU,
+    0x24aa3f05U, 0xd6c1bc06U, 0xc5914ff2U, 0x37faccf1U, 0x69e9f0d5U, 0x9b8273d6U,
+    0x88d28022U, 0x7ab90321U, 0xae7367caU, 0x5c18e4c9U, 0x4f48173dU, 0xbd23943eU,
+    0xf36e6f75U, 0x0105ec76U, 0x12551f82U, 0xe03e9c81U, 0x34f4f86aU, 0xc69f7b69U,
+    0xd5cf889dU, 0x27a40b9eU, 0x79b737baU, 0x8bdcb4b9U, 0x988c474dU, 0x6ae7c44eU,
+    0xbe2da0a5U, 0x4c4623a6U, 0x5f16d052U, 0xad7d5351U
+};
+
+
+static uint32_t aghs_crc32c_u64_soft( uint32_t crc, ag_hash_t v )
+{
+    for ( int i = 0; i < 8; i++ ) {
+        crc = aghs_crc_table[ ( crc ^ v ) & 0xff ] ^ ( crc >> 8 );
+        v >>= 8;
+    }
+    return crc;
+}
+
+
+/*
+ * Hash body, parametrized with the CRC update function.
+ */
+#define AGHS_CRC_BODY( crc64 )                                                           \
+    {                                                                                    \
+        const uint8_t* p = (const uint8_t*)input;                                        \
+        size_t         rem = len;                                                        \
+        uint32_t       a = (uint32_t)seed;                                               \
+        uint32_t       b = (uint32_t)( seed >> 32 ) ^ 0x9e3779b9U;                       \
+        ag_hash_t      lo;                                                               \
+        ag_hash_t      hi;                                                               \
+                                                                                         \
+        while ( rem >= 16 ) {                                                            \
+            a = crc64( a, aghs_read64( p ) );                                            \
+            b = crc64( b, aghs_read64( p + 8 ) );                                        \
+            p += 16;                                                                     \
+            rem -= 16;                                                                   \
+        }                                                                                \
+                                                                                         \
+        if ( rem ) {                                                                     \
+            if ( rem >= 8 ) {                                                            \
+                lo = aghs_read64( p );                                                   \
+                hi = aghs_read64( p + rem - 8 );                                         \
+            } else if ( rem >= 4 ) {                                                     \
+                lo = aghs_read32( p ) | ( (ag_hash_t)aghs_read32( p + rem - 4 ) << 32 ); \
+                hi = 0;                                                                  \
+            } else {                                                                     \
+                lo = p[ 0 ] | ( (ag_hash_t)p[ rem >> 1 ] << 8 ) |                        \
+                     ( (ag_hash_t)p[ rem - 1 ] << 16 );                                  \
+                hi = 0;                                                                  \
+            }                                                                            \
+            a = crc64( a, lo );                                                          \
+            b = crc64( b, hi ^ ( lo * PRIME64_1 ) );                                     \
+        }                                                                                \
+                                                                                         \
+        return aghs_64_avalanche( ( ( (ag_hash_t)b << 32 ) | a ) ^ ( len * PRIME64_2 ) ); \
+    }
+
+
+static ag_hash_t aghs_crc_64_soft( const void* input, size_t len, ag_hash_t seed )
+AGHS_CRC_BODY( aghs_crc32c_u64_soft )
+
+
+#if defined( __x86_64__ )
+
+#define AGHS_TARGET_SSE42 __attribute__( ( target( "sse4.2" ) ) )
+
+AGHS_TARGET_SSE42 FORCE_INLINE uint32_t aghs_crc32c_u64_sse42( uint32_t crc, ag_hash_t v )
+{
+    return (uint32_t)_mm_crc32_u64( crc, v );
+}
+
+AGHS_TARGET_SSE42 static ag_hash_t aghs_crc_64_sse42( const void* input, size_t len, ag_hash_t seed )
+AGHS_CRC_BODY( aghs_crc32c_u64_sse42 )
+
+#endif
+
+
+/** CRC hash function. */
+typedef ag_hash_t ( *aghs_crc_fn_p )( const void* input, size_t len, ag_hash_t seed );
+
+/** Selected CRC hash (accessed atomically, see aghs_wide_loop). */
+static aghs_crc_fn_p aghs_crc_fn = NULL;
+
+
+aghs_crc_impl_t aghs_crc_select( aghs_crc_impl_t impl )
+{
+#if defined( __x86_64__ )
+    __builtin_cpu_init();
+    if ( impl != aghs_crc_soft && __builtin_cpu_supports( "sse4.2" ) ) {
+        __atomic_store_n( &aghs_crc_fn, aghs_crc_64_sse42, __ATOMIC_RELEASE );
+        return aghs_crc_sse42;
+    }
+#endif
+
+    (void)impl;
+    __atomic_store_n( &aghs_crc_fn, aghs_crc_64_soft, __ATOMIC_RELEASE );
+    return aghs_crc_soft;
+}
+
+
+ag_hash_t aghs_crc_64_with_seed( const void* input, size_t len, ag_hash_t seed )
+{
+    aghs_crc_fn_p fn;
+
+    fn = __atomic_load_n( &aghs_crc_fn, __ATOMIC_ACQUIRE );
+    if ( fn == NULL ) {
+        aghs_crc_select( aghs_crc_auto );
+        fn = __atomic_load_n( &aghs_crc_fn, __ATOMIC_ACQUIRE );
+    }
+
+    return fn( input, len, seed );
+}
+
+
+ag_hash_t aghs_crc_64( const void* input, size_t len )
+{
+    return aghs_crc_64_with_seed( input, len, 0 );
+}
+
+
+
+/* ------------------------------------------------------------
+ * Batch section:
+ *
+ * Hashes of a batch are independent of each other. AGHS_BATCH_LANES
+ * short keys are hashed in lockstep, one length step at a time for
+ * all lanes, so that the multiply chains of the lanes overlap. The
+ * lanes have different lengths, hence each step is executed for
+ * every lane, and the result is selected with the length bit mask.
+ * Lanes that skip a step load from a zero block, instead of the
+ * input. There are no data dependent jumps, which would mispredict
+ * with mixed key lengths.
+ *
+ * NOTE: SIMD lanes (AVX-512, one key per 64-bit lane) were
+ * evaluated, but since 64-bit vector multiplies are expensive, they
+ * were slower than the scalar lanes.
+ */
+
+/** Number of keys hashed in lockstep. */
+#define AGHS_BATCH_LANES 8
+
+/** Apply "op" to each batch lane index (AGHS_BATCH_LANES). */
+#define AGHS_BATCH_EACH( op ) op( 0 ) op( 1 ) op( 2 ) op( 3 ) op( 4 ) op( 5 ) op( 6 ) op( 7 )
+
+/** Load source for lanes that skip a length step. */
+static const uint8_t aghs_batch_zero[ 16 ] = { 0 };
+
+
+/**
+ * Execute one length step (length bit "bit") for a batch lane.
+ *
+ * Step is executed regardless of the length, and the hash is
+ * selected with the length bit mask.
+ *
+ * @param h   Lane hash.
+ * @param p   Lane input position (updated).
+ * @param n   Lane input length.
+ * @param bit Length bit (16, 8, 4, 2 or 1).
+ *
+ * @return Updated lane hash.
+ */
+AGHS_ALWAYS_INLINE ag_hash_t aghs_64_batch_step( ag_hash_t h, const uint8_t** p, size_t n, size_t bit )
+{
+    ag_hash_t const m = (ag_hash_t)0 - ( ( n / bit ) & 1 );
+    const uint8_t*  q;
+    ag_hash_t       v;
+
+    q = (const uint8_t*)( ( (uintptr_t)*p & m ) | ( (uintptr_t)aghs_batch_zero & ~m ) );
+
+    switch ( bit ) {
+        case 16:
+            v = aghs_64_mix8( h, aghs_load64( q ) );
+            v = aghs_64_mix8( v, aghs_load64( q + 8 ) );
+            break;
+        case 8: v = aghs_64_mix8( h, aghs_load64( q ) ); break;
+        case 4: v = aghs_64_mix4( h, aghs_load32( q ) ); break;
+        case 2: v = aghs_64_mix1( aghs_64_mix1( h, q[ 0 ] ), q[ 1 ] ); break;
+        default: v = aghs_64_mix1( h, q[ 0 ] ); break;
+    }
+
+    *p += n & bit;
+
+    return ( v & m ) | ( h & ~m );
+}
+
+
+/**
+ * Hash AGHS_BATCH_LANES short (below 32 bytes) inputs in lockstep.
+ *
+ * @param inputs  Input data array.
+ * @param lengths Input data length array.
+ * @param seed    Hash seed.
+ * @param hashes  Hash array (output).
+ */
+AGHS_ALWAYS_INLINE void aghs_64_batch_lanes( const void* const* inputs,
+                                             const size_t*      lengths,
+                                             ag_hash_t          seed,
+                                             ag_hash_t*         hashes )
+{
+    size_t bit;
+
+    /* Lane state is in separate variables (registers), not arrays. */
+#define AGHS_BATCH_INIT( l )                                \
+    const uint8_t* p##l = (const uint8_t*)inputs[ l ];      \
+    size_t const   n##l = lengths[ l ];                     \
+    ag_hash_t      h##l = seed + PRIME64_5 + (ag_hash_t)n##l;
+
+#define AGHS_BATCH_STEP( l ) h##l = aghs_64_batch_step( h##l, &p##l, n##l, bit );
+
+#define AGHS_BATCH_DONE( l ) hashes[ l ] = aghs_64_avalanche( h##l );
+
+    AGHS_BATCH_EACH( AGHS_BATCH_INIT )
+
+    /* Steps are not looped, so that "bit" is constant in each. */
+    bit = 16;
+    AGHS_BATCH_EACH( AGHS_BATCH_STEP )
+    bit = 8;
+    AGHS_BATCH_EACH( AGHS_BATCH_STEP )
+    bit = 4;
+    AGHS_BATCH_EACH( AGHS_BATCH_STEP )
+    bit = 2;
+    AGHS_BATCH_EACH( AGHS_BATCH_STEP )
+    bit = 1;
+    AGHS_BATCH_EACH( AGHS_BATCH_STEP )
+
+    AGHS_BATCH_EACH( AGHS_BATCH_DONE )
+
+#undef AGHS_BATCH_INIT
+#undef AGHS_BATCH_STEP
+#undef AGHS_BATCH_DONE
+}
+
+
+void aghs_64_batch( const void* const* inputs,
+                    const size_t*      lengths,
+                    size_t             cnt,
+                    ag_hash_t          seed,
+                    ag_hash_t*         hashes )
+{
+    size_t i;
+    size_t l;
+
+    for ( i = 0; i + AGHS_BATCH_LANES <= cnt; i += AGHS_BATCH_LANES ) {
+
+        /* Long keys in group: hash group one by one. */
+        for ( l = 0; l < AGHS_BATCH_LANES && lengths[ i + l ] < 32; l++ )
+            ;
+
+        if ( l == AGHS_BATCH_LANES ) {
+            aghs_64_batch_lanes( inputs + i, lengths + i, seed, hashes + i );
+        } else {
+            for ( l = 0; l < AGHS_BATCH_LANES; l++ )
+                hashes[ i + l ] = aghs_64_short_with_seed( inputs[ i + l ], lengths[ i + l ], seed );
+        }
+    }
+
+    for ( ; i < cnt; i++ )
+        hashes[ i ] = aghs_64_short_with_seed( inputs[ i ], lengths[ i ], seed );
+}
+
+
+void aghs_64_batch_postor( po_t po, aghs_key_fn_p key, ag_hash_t seed, ag_hash_t* hashes )
+{
+    const void* inputs[ AGHS_BATCH_LANES ];
+    size_t      lengths[ AGHS_BATCH_LANES ];
+    po_size_t   i;
+    po_size_t   j;
+
+    /* Extract keys for lanes, and hash them as batch. */
+    for ( i = 0; i < po->used; i += j ) {
+        for ( j = 0; j < AGHS_BATCH_LANES && i + j < po->used; j++ )
+            key( po->data[ i + j ], &inputs[ j ], &lengths[ j ] );
+        aghs_64_batch( inputs, lengths, j, seed, hashes + i );
+    }
+}
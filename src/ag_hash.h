@@ -48,6 +48,8 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <postor.h>
 #include <alogir.h>
 
 #define AG_HASH_PUBLIC_API
@@ -87,4 +89,558 @@ AG_HASH_PUBLIC_API ag_hash_t aghs_64( const void* input, size_t length );
 AG_HASH_PUBLIC_API ag_hash_t aghs_64_with_seed( const void* input, size_t length, ag_hash_t seed );
 
 
+
+/**
+ * Calculate 128-bit hash value from input.
+ *
+ * Low 64 bits of the result are identical to aghs_64().
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ *
+ * @return 128-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash128_t aghs_128( const void* input, size_t length );
+
+
+/**
+ * Calculate 128-bit hash value from input using seed.
+ *
+ * Low 64 bits of the result are identical to aghs_64_with_seed().
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ * @param seed   Hash seed.
+ *
+ * @return 128-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash128_t aghs_128_with_seed( const void* input, size_t length, ag_hash_t seed );
+
+
+/**
+ * Return 1 if 128-bit hash values are equal.
+ *
+ * @param a Hash value.
+ * @param b Hash value.
+ *
+ * @return 1 for equal (else 0).
+ */
+static inline int aghs_128_equal( ag_hash128_t a, ag_hash128_t b )
+{
+    return ( a.lo == b.lo ) & ( a.hi == b.hi );
+}
+
+
+
+/* ------------------------------------------------------------
+ * Inline short-key hash:
+ */
+
+/** @cond ag_hash_no_doxygen */
+
+#define AGHS_PRIME64_1 11400714785074694791ULL
+#define AGHS_PRIME64_2 14029467366897019727ULL
+#define AGHS_PRIME64_3 1609587929392839161ULL
+#define AGHS_PRIME64_4 9650029242287828579ULL
+#define AGHS_PRIME64_5 2870177450012600261ULL
+
+#define aghs_rotl64( x, r ) ( ( x << r ) | ( x >> ( 64 - r ) ) )
+
+static inline ag_hash_t aghs_load64( const void* ptr )
+{
+    ag_hash_t val;
+    memcpy( &val, ptr, sizeof( val ) );
+    return val;
+}
+
+static inline uint32_t aghs_load32( const void* ptr )
+{
+    uint32_t val;
+    memcpy( &val, ptr, sizeof( val ) );
+    return val;
+}
+
+static inline ag_hash_t aghs_64_round( ag_hash_t acc, ag_hash_t input )
+{
+    acc += input * AGHS_PRIME64_2;
+    acc = aghs_rotl64( acc, 31 );
+    acc *= AGHS_PRIME64_1;
+    return acc;
+}
+
+static inline ag_hash_t aghs_64_avalanche( ag_hash_t h64 )
+{
+    h64 ^= h64 >> 33;
+    h64 *= AGHS_PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= AGHS_PRIME64_3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
+
+static inline ag_hash_t aghs_64_mix8( ag_hash_t h64, ag_hash_t k )
+{
+    h64 ^= aghs_64_round( 0, k );
+    return aghs_rotl64( h64, 27 ) * AGHS_PRIME64_1 + AGHS_PRIME64_4;
+}
+
+static inline ag_hash_t aghs_64_mix4( ag_hash_t h64, uint32_t k )
+{
+    h64 ^= (ag_hash_t)k * AGHS_PRIME64_1;
+    return aghs_rotl64( h64, 23 ) * AGHS_PRIME64_2 + AGHS_PRIME64_3;
+}
+
+static inline ag_hash_t aghs_64_mix1( ag_hash_t h64, uint8_t k )
+{
+    h64 ^= k * AGHS_PRIME64_5;
+    return aghs_rotl64( h64, 11 ) * AGHS_PRIME64_1;
+}
+
+/** @endcond ag_hash_no_doxygen */
+
+
+/**
+ * Calculate 64-bit hash value from short input using seed.
+ *
+ * Result is identical to aghs_64_with_seed(), but inputs shorter
+ * than 32 bytes are hashed inline. Each length class (16, 8, 4, 2
+ * and 1 bytes) is one test of the length bits, and with a compile
+ * time constant length all tests fold away. Input may be NULL only
+ * if length is 0.
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ * @param seed   Hash seed.
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_64_short_with_seed( const void* input, size_t length, ag_hash_t seed )
+{
+    const uint8_t* p = (const uint8_t*)input;
+    ag_hash_t      h64;
+
+    if ( length >= 32 )
+        return aghs_64_with_seed( input, length, seed );
+
+    h64 = seed + AGHS_PRIME64_5 + (ag_hash_t)length;
+
+    if ( length & 16 ) {
+        h64 = aghs_64_mix8( h64, aghs_load64( p ) );
+        h64 = aghs_64_mix8( h64, aghs_load64( p + 8 ) );
+        p += 16;
+    }
+    if ( length & 8 ) {
+        h64 = aghs_64_mix8( h64, aghs_load64( p ) );
+        p += 8;
+    }
+    if ( length & 4 ) {
+        h64 = aghs_64_mix4( h64, aghs_load32( p ) );
+        p += 4;
+    }
+    if ( length & 2 ) {
+        h64 = aghs_64_mix1( h64, p[ 0 ] );
+        h64 = aghs_64_mix1( h64, p[ 1 ] );
+        p += 2;
+    }
+    if ( length & 1 ) {
+        h64 = aghs_64_mix1( h64, p[ 0 ] );
+    }
+
+    return aghs_64_avalanche( h64 );
+}
+
+
+/**
+ * Calculate 64-bit hash value from short input.
+ *
+ * See aghs_64_short_with_seed() for details.
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_64_short( const void* input, size_t length )
+{
+    return aghs_64_short_with_seed( input, length, 0 );
+}
+
+
+
+/* ------------------------------------------------------------
+ * Inline integer hash:
+ *
+ * Integer hashes are identical to aghs_64() of the integer's (little
+ * endian) bytes.
+ */
+
+/**
+ * Calculate 64-bit hash value from 32-bit integer.
+ *
+ * @param key Integer key.
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_u32( uint32_t key )
+{
+    return aghs_64_avalanche( aghs_64_mix4( AGHS_PRIME64_5 + 4, key ) );
+}
+
+
+/**
+ * Calculate 64-bit hash value from 64-bit integer.
+ *
+ * @param key Integer key.
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_u64( uint64_t key )
+{
+    return aghs_64_avalanche( aghs_64_mix8( AGHS_PRIME64_5 + 8, key ) );
+}
+
+
+/**
+ * Calculate 64-bit hash value from pointer.
+ *
+ * @param key Pointer key.
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_ptr( const void* key )
+{
+    return aghs_u64( (uint64_t)(uintptr_t)key );
+}
+
+
+/**
+ * Calculate 64-bit hash value from pair of 64-bit integers.
+ *
+ * @param a First integer key.
+ * @param b Second integer key.
+ *
+ * @return 64-bit hash.
+ */
+static inline ag_hash_t aghs_u64_pair( uint64_t a, uint64_t b )
+{
+    return aghs_64_avalanche( aghs_64_mix8( aghs_64_mix8( AGHS_PRIME64_5 + 16, a ), b ) );
+}
+
+
+
+/* ------------------------------------------------------------
+ * CRC hash:
+ */
+
+/**
+ * CRC hash implementations.
+ *
+ * CRC hash is based on CRC32C, for which x86_64 has the SSE4.2 crc32
+ * instruction. The portable implementation is table based and gives
+ * identical values, but it is much slower. CRC hash values are
+ * intended for in-process tables, i.e. they are not guaranteed to be
+ * stable between library versions.
+ */
+typedef enum
+{
+    aghs_crc_auto = 0,  /**< Best available implementation. */
+    aghs_crc_soft = 1,  /**< Portable table based implementation. */
+    aghs_crc_sse42 = 2, /**< SSE4.2 crc32 instruction. */
+} aghs_crc_impl_t;
+
+
+/**
+ * Select CRC hash implementation.
+ *
+ * By default the best implementation supported by the CPU is
+ * selected at first use. If the requested implementation is not
+ * supported, the portable one is selected instead.
+ *
+ * @param impl Requested implementation.
+ *
+ * @return Implementation in use.
+ */
+AG_HASH_PUBLIC_API aghs_crc_impl_t aghs_crc_select( aghs_crc_impl_t impl );
+
+
+/**
+ * Calculate 64-bit CRC hash value from input.
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_crc_64( const void* input, size_t length );
+
+
+/**
+ * Calculate 64-bit CRC hash value from input using seed.
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ * @param seed   Hash seed.
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_crc_64_with_seed( const void* input,
+                                                    size_t      length,
+                                                    ag_hash_t   seed );
+
+
+
+/* ------------------------------------------------------------
+ * Batch hash:
+ */
+
+/**
+ * Key extraction function for batch hashing of Postor items.
+ *
+ * @param item   Postor item.
+ * @param key    Key data (output).
+ * @param length Key data length (output).
+ */
+typedef void ( *aghs_key_fn_p )( const po_d item, const void** key, size_t* length );
+
+
+/**
+ * Calculate 64-bit hash values for a batch of inputs.
+ *
+ * Hash values are identical to aghs_64_with_seed(). Inputs are
+ * hashed in groups of 8, and groups where all inputs are shorter than
+ * 32 bytes are hashed in lockstep without jumps, so that the multiply
+ * chains of the inputs overlap.
+ *
+ * @param inputs  Input data array.
+ * @param lengths Input data length array.
+ * @param cnt     Number of inputs.
+ * @param seed    Hash seed.
+ * @param hashes  Hash array (output).
+ */
+AG_HASH_PUBLIC_API void aghs_64_batch( const void* const* inputs,
+                                       const size_t*      lengths,
+                                       size_t             cnt,
+                                       ag_hash_t          seed,
+                                       ag_hash_t*         hashes );
+
+
+/**
+ * Calculate 64-bit hash values for all Postor items.
+ *
+ * Key for each item is extracted with key function. See
+ * aghs_64_batch() for details.
+ *
+ * @param po     Postor.
+ * @param key    Key extraction function.
+ * @param seed   Hash seed.
+ * @param hashes Hash array (output, Postor used count of entries).
+ */
+AG_HASH_PUBLIC_API void aghs_64_batch_postor( po_t          po,
+                                              aghs_key_fn_p key,
+                                              ag_hash_t     seed,
+                                              ag_hash_t*    hashes );
+
+
+
+/* ------------------------------------------------------------
+ * Tree hash:
+ */
+
+/** Tree hash leaf size (in bytes). */
+#define AGHS_TREE_LEAF_SIZE ( 1024 * 1024 )
+
+
+/**
+ * Calculate 64-bit tree hash value from input using seed.
+ *
+ * Input is split to AGHS_TREE_LEAF_SIZE leaves, and each leaf is
+ * hashed with aghs_64_with_seed(). The result is aghs_64_with_seed()
+ * of the leaf hashes. Leaves are hashed with "threads" number of
+ * threads, but the result is the same for any thread count.
+ *
+ * @param input   Input data.
+ * @param length  Input data length (in bytes).
+ * @param seed    Hash seed.
+ * @param threads Number of threads (1 or less means no threads).
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_64_tree( const void* input,
+                                           size_t      length,
+                                           ag_hash_t   seed,
+                                           int         threads );
+
+
+
+/* ------------------------------------------------------------
+ * File hash:
+ */
+
+/**
+ * Calculate 64-bit hash value of file content.
+ *
+ * Regular files are memory mapped, and other files (e.g. pipes) are
+ * read in chunks. The result is identical to aghs_64() of the file
+ * content. Seekable files are hashed from the start, independent of
+ * the current file offset.
+ *
+ * @param fd   File descriptor.
+ * @param hash Hash value (output).
+ *
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+AG_HASH_PUBLIC_API int aghs_64_fd( int fd, ag_hash_t* hash );
+
+
+/**
+ * Calculate 64-bit hash value of file content.
+ *
+ * See aghs_64_fd() for details.
+ *
+ * @param path File path.
+ * @param hash Hash value (output).
+ *
+ * @return 0 on success, -1 on failure (errno is set).
+ */
+AG_HASH_PUBLIC_API int aghs_64_file( const char* path, ag_hash_t* hash );
+
+
+
+/* ------------------------------------------------------------
+ * Streaming hash:
+ */
+
+/**
+ * Streaming hash state.
+ *
+ * Input can be fed to the state in arbitrary sized pieces. The
+ * result is identical to hashing the concatenated input with
+ * aghs_64_with_seed().
+ */
+struct aghs_state_s
+{
+    ag_hash_t total;      /**< Total input length. */
+    ag_hash_t v[ 4 ];     /**< Lane accumulators. */
+    ag_hash_t mem[ 4 ];   /**< Buffer for partial stripe. */
+    uint32_t  memsize;    /**< Bytes used in buffer. */
+    ag_hash_t seed;       /**< Hash seed. */
+};
+
+/** Short type for hash state struct. */
+typedef struct aghs_state_s aghs_state_s;
+
+/** Handle type for hash state. */
+typedef struct aghs_state_s* aghs_state_t;
+
+
+/**
+ * Initialize (or reset) streaming hash state.
+ *
+ * @param st   Hash state.
+ * @param seed Hash seed.
+ */
+AG_HASH_PUBLIC_API void aghs_64_init( aghs_state_t st, ag_hash_t seed );
+
+
+/**
+ * Feed input to streaming hash state.
+ *
+ * @param st     Hash state.
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ */
+AG_HASH_PUBLIC_API void aghs_64_update( aghs_state_t st, const void* input, size_t length );
+
+
+/**
+ * Calculate 64-bit hash value from streaming hash state.
+ *
+ * State is not modified, hence more input can be fed after digest.
+ *
+ * @param st Hash state.
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_64_digest( aghs_state_t st );
+
+
+/**
+ * Calculate 128-bit hash value from streaming hash state.
+ *
+ * Streaming state is shared with 64-bit hash, i.e. state is
+ * initialized with aghs_64_init() and fed with aghs_64_update(). The
+ * result is identical to aghs_128_with_seed() of the concatenated
+ * input.
+ *
+ * @param st Hash state.
+ *
+ * @return 128-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash128_t aghs_128_digest( aghs_state_t st );
+
+
+
+/* ------------------------------------------------------------
+ * Wide hash:
+ */
+
+/**
+ * Wide hash implementations.
+ *
+ * Wide hash processes 64 byte stripes with eight accumulator
+ * lanes. The lanes map directly to SSE2, AVX2 and AVX-512 registers,
+ * and every implementation produces identical hash values.
+ */
+typedef enum
+{
+    aghs_wide_auto = 0,   /**< Best available implementation. */
+    aghs_wide_scalar = 1, /**< Portable reference implementation. */
+    aghs_wide_sse2 = 2,   /**< SSE2 implementation. */
+    aghs_wide_avx2 = 3,   /**< AVX2 implementation. */
+    aghs_wide_avx512 = 4, /**< AVX-512 implementation. */
+} aghs_wide_impl_t;
+
+
+/**
+ * Select wide hash implementation.
+ *
+ * By default the best implementation supported by the CPU is
+ * selected at first use. If the requested implementation is not
+ * supported by the CPU, the best supported one is selected instead.
+ *
+ * @param impl Requested implementation.
+ *
+ * @return Implementation in use.
+ */
+AG_HASH_PUBLIC_API aghs_wide_impl_t aghs_wide_select( aghs_wide_impl_t impl );
+
+
+/**
+ * Calculate 64-bit wide hash value from input.
+ *
+ * Wide hash is intended for large inputs. Inputs shorter than 64
+ * bytes produce the same value as aghs_64().
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_wide_64( const void* input, size_t length );
+
+
+/**
+ * Calculate 64-bit wide hash value from input using seed.
+ *
+ * @param input  Input data.
+ * @param length Input data length (in bytes).
+ * @param seed   Hash seed.
+ *
+ * @return 64-bit hash.
+ */
+AG_HASH_PUBLIC_API ag_hash_t aghs_wide_64_with_seed( const void* input,
+                                                     size_t      length,
+                                                     ag_hash_t   seed );
+
+
 #endif
@@ -6,8 +6,17 @@
  * @brief  Heap algorithms over containers.
  */
 
+#include <string.h>
 #include "ag_heap.h"
 
+#if defined( AGHP_STATS ) && defined( AGHP_STATS_CYCLES )
+#if defined( __x86_64__ )
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#endif
+
 
 /** First location of data in heap. */
 #define AGHP_FIRST 1
@@ -19,7 +28,61 @@
 #define aghp_nth( h, nth ) ( ( ( h )->po->data )[ (nth)-1 ] )
 
 
+
+/*
+ * Statistics (see AGHP_STATS in ag_heap.h). Without AGHP_STATS all
+ * macros expand to nothing.
+ */
+#ifdef AGHP_STATS
+
+/** Add to statistics counter. */
+#define aghp_stat_add( h, field, n ) ( ( h )->stats.field += ( n ) )
+
+/** Update max depth statistics. */
+#define aghp_stat_depth( h, d )                   \
+    do {                                          \
+        if ( ( d ) > ( h )->stats.max_depth )     \
+            ( h )->stats.max_depth = ( d );       \
+    } while ( 0 )
+
+/**
+ * Levels between lower index "lo" and its ancestor "hi".
+ */
+static inline po_size_t aghp_depth( po_size_t lo, po_size_t hi )
+{
+    po_size_t d = 0;
+    while ( lo > hi ) {
+        lo /= 2;
+        d++;
+    }
+    return d;
+}
+
+#ifdef AGHP_STATS_CYCLES
+static uint64_t aghp_cycles( void );
+/** Start operation (timing). */
+#define aghp_op_begin( h ) uint64_t const aghp_t0_ = aghp_cycles()
+/** End operation (timing). */
+#define aghp_op_end( h ) \
+    ( ( h )->stats.ops++, ( h )->stats.cycles += aghp_cycles() - aghp_t0_ )
+#else
+#define aghp_op_begin( h )
+#define aghp_op_end( h ) ( ( h )->stats.ops++ )
+#endif
+
+#else
+
+#define aghp_stat_add( h, field, n )
+#define aghp_stat_depth( h, d )
+#define aghp_op_begin( h )
+#define aghp_op_end( h )
+
+#endif
+
+
 static int aghp_compare( aghp_t h, const po_d a, const po_d b );
+static void aghp_sift_up( aghp_t h, po_size_t i, po_d item );
+static void aghp_sift_down( aghp_t h, po_size_t i, po_d item );
 
 
 
@@ -38,6 +101,7 @@ void aghp_init( aghp_t h, po_t po, po_compare_fn_p cmp, po_pos_t dir )
     h->cmp = cmp;
     h->cnt = AGHP_FIRST - AGHP_FIRST;
     h->polar = dir;
+    aghp_stats_reset( h );
 }
 
 
@@ -50,7 +114,7 @@ aghp_t aghp_del( aghp_t h )
 
 void aghp_put( aghp_t h, po_d item )
 {
-    po_size_t i;
+    aghp_op_begin( h );
 
     if ( h->cnt >= h->po->used )
         po_push( h->po, NULL );
@@ -60,16 +124,48 @@ void aghp_put( aghp_t h, po_d item )
      * starts at 1. Index is reverted back to array index within
      * aghp_nth().
      */
-    i = ++h->cnt;
+    aghp_sift_up( h, ++h->cnt, item );
 
-    /* Drop data downwards until proper place for new data is found. */
-    while ( i > AGHP_FIRST && aghp_compare( h, aghp_nth( h, i / 2 ), item ) > 0 ) {
-        aghp_nth( h, i ) = aghp_nth( h, i / 2 );
-        i /= 2;
+    aghp_op_end( h );
+}
+
+
+void aghp_put_many( aghp_t h, po_d* items, po_size_t cnt )
+{
+    po_size_t old;
+    po_size_t depth;
+
+    aghp_op_begin( h );
+
+    old = h->cnt;
+
+    /* Append all items. */
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        if ( h->cnt >= h->po->used )
+            po_push( h->po, items[ i ] );
+        else
+            aghp_nth( h, h->cnt + 1 ) = items[ i ];
+        h->cnt++;
     }
+    aghp_stat_add( h, moves, cnt );
 
-    /* Add new data. */
-    aghp_nth( h, i ) = item;
+    for ( depth = 1; ( (po_size_t)1 << depth ) <= h->cnt; depth++ )
+        ;
+
+    if ( cnt * depth < h->cnt ) {
+
+        /* Few items: drop each new item to its place. */
+        for ( po_size_t i = old + 1; i <= h->cnt; i++ )
+            aghp_sift_up( h, i, aghp_nth( h, i ) );
+
+    } else {
+
+        /* Many items: rebuild the heap bottom-up. */
+        for ( po_size_t i = h->cnt / 2; i >= AGHP_FIRST; i-- )
+            aghp_sift_down( h, i, aghp_nth( h, i ) );
+    }
+
+    aghp_op_end( h );
 }
 
 
@@ -81,50 +177,107 @@ po_d aghp_get( aghp_t h )
 
     } else {
 
-        po_size_t i;
-        po_size_t child;
-
         po_d ret;
         po_d last;
 
+        aghp_op_begin( h );
+
         ret = aghp_nth( h, AGHP_FIRST );
         last = aghp_nth( h, h->cnt-- );
 
-        i = AGHP_FIRST;
+        aghp_sift_down( h, AGHP_FIRST, last );
 
-        /*
-         * Copy data upwards until the heap is again in (heap)
-         * order.
-         */
-        while ( i * 2 <= h->cnt ) {
+        aghp_op_end( h );
 
-            /* Find the smaller child of two. */
-            child = i * 2;
-            if ( ( child != h->cnt ) &&
-                 ( aghp_compare( h, aghp_nth( h, child + 1 ), aghp_nth( h, child ) ) < 0 ) )
-                child++;
+        return ret;
+    }
+}
+
+
+po_d aghp_peek( aghp_t h )
+{
+    if ( aghp_is_empty( h ) )
+        return NULL;
+    else
+        return aghp_nth( h, AGHP_FIRST );
+}
 
-            /* Percolate down. */
-            if ( aghp_compare( h, last, aghp_nth( h, child ) ) > 0 )
-                aghp_nth( h, i ) = aghp_nth( h, child );
-            else
-                break;
 
-            i = child;
-        }
+po_d aghp_pushpop( aghp_t h, po_d item )
+{
+    po_d ret;
 
-        aghp_nth( h, i ) = last;
+    aghp_op_begin( h );
 
-        return ret;
+    if ( aghp_is_empty( h ) || aghp_compare( h, item, aghp_nth( h, AGHP_FIRST ) ) <= 0 ) {
+        ret = item;
+    } else {
+        ret = aghp_nth( h, AGHP_FIRST );
+        aghp_sift_down( h, AGHP_FIRST, item );
     }
+
+    aghp_op_end( h );
+
+    return ret;
 }
 
 
-void aghp_ify( aghp_t h )
+po_d aghp_replace( aghp_t h, po_d item )
 {
-    for ( po_size_t i = 1; i <= h->po->used; i++ ) {
-        aghp_put( h, aghp_nth( h, i ) );
+    po_d ret;
+
+    if ( aghp_is_empty( h ) ) {
+        aghp_put( h, item );
+        return NULL;
+    }
+
+    aghp_op_begin( h );
+
+    ret = aghp_nth( h, AGHP_FIRST );
+    aghp_sift_down( h, AGHP_FIRST, item );
+
+    aghp_op_end( h );
+
+    return ret;
+}
+
+
+po_size_t aghp_get_many( aghp_t h, po_size_t n, po_d* out )
+{
+    po_size_t i;
+
+    aghp_op_begin( h );
+
+    if ( n > h->cnt )
+        n = h->cnt;
+
+    for ( i = 0; i < n; i++ ) {
+        out[ i ] = aghp_nth( h, AGHP_FIRST );
+        h->cnt--;
+        aghp_sift_down( h, AGHP_FIRST, aghp_nth( h, h->cnt + 1 ) );
     }
+
+    aghp_op_end( h );
+
+    return n;
+}
+
+
+void aghp_ify( aghp_t h )
+{
+    /*
+     * Floyd's bottom-up heap construction: leaves are heaps as such,
+     * and each parent is pushed down to its place, starting from the
+     * last parent. This takes O(n) compares.
+     */
+    aghp_op_begin( h );
+
+    h->cnt = h->po->used;
+
+    for ( po_size_t i = h->cnt / 2; i >= AGHP_FIRST; i-- )
+        aghp_sift_down( h, i, aghp_nth( h, i ) );
+
+    aghp_op_end( h );
 }
 
 
@@ -144,7 +297,9 @@ void aghp_sort( aghp_t h )
 
     aghp_inv_polar( h );
     for ( po_size_t i = 0; i < lim; i++ ) {
-        aghp_nth( h, h->cnt + 1 ) = aghp_get( h );
+        po_d item = aghp_get( h );
+        aghp_nth( h, h->cnt + 1 ) = item;
+        aghp_stat_add( h, moves, 1 );
     }
     aghp_inv_polar( h );
 }
@@ -159,6 +314,46 @@ void aghp_sort_postor( po_t po, po_compare_fn_p cmp, po_pos_t dir )
 }
 
 
+void aghp_topk( po_t po, po_size_t k, po_compare_fn_p cmp, po_pos_t dir, po_t out )
+{
+    aghp_topk_s ts;
+
+    aghp_topk_init( &ts, out, k, cmp, dir );
+    for ( po_size_t i = 0; i < po->used; i++ )
+        aghp_topk_put( &ts, po->data[ i ] );
+    aghp_topk_done( &ts );
+}
+
+
+void aghp_topk_init( aghp_topk_t t, po_t out, po_size_t k, po_compare_fn_p cmp, po_pos_t dir )
+{
+    out->used = 0;
+    aghp_init( &t->heap, out, cmp, -dir );
+    t->k = k;
+}
+
+
+void aghp_topk_put( aghp_topk_t t, po_d item )
+{
+    aghp_t h = &t->heap;
+
+    if ( h->cnt < t->k ) {
+        aghp_put( h, item );
+    } else if ( t->k > 0 && aghp_compare( h, item, aghp_nth( h, AGHP_FIRST ) ) > 0 ) {
+        /* Item is better than the worst selected (root), replace root. */
+        aghp_replace( h, item );
+    }
+}
+
+
+void aghp_topk_done( aghp_topk_t t )
+{
+    /* Heap is already in the inverted polarity used for sorting. */
+    aghp_inv_polar( &t->heap );
+    aghp_sort( &t->heap );
+}
+
+
 int aghp_is_empty( aghp_t h )
 {
     if ( h->cnt > 0 )
@@ -185,6 +380,27 @@ po_pos_t aghp_get_polar( aghp_t h )
 }
 
 
+void aghp_stats( aghp_t h, aghp_stats_s* stats )
+{
+#ifdef AGHP_STATS
+    *stats = h->stats;
+#else
+    (void)h;
+    memset( stats, 0, sizeof( aghp_stats_s ) );
+#endif
+}
+
+
+void aghp_stats_reset( aghp_t h )
+{
+#ifdef AGHP_STATS
+    memset( &h->stats, 0, sizeof( aghp_stats_s ) );
+#else
+    (void)h;
+#endif
+}
+
+
 
 /* ------------------------------------------------------------
  * Internal support:
@@ -202,5 +418,90 @@ po_pos_t aghp_get_polar( aghp_t h )
  */
 static int aghp_compare( aghp_t h, const po_d a, const po_d b )
 {
+    aghp_stat_add( h, compares, 1 );
     return h->polar * h->cmp( a, b );
 }
+
+
+#if defined( AGHP_STATS ) && defined( AGHP_STATS_CYCLES )
+/**
+ * Return current time for operation timing.
+ *
+ * @return TSC ticks on x86-64, otherwise monotonic ns.
+ */
+static uint64_t aghp_cycles( void )
+{
+#if defined( __x86_64__ )
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+#endif
+
+
+/**
+ * Drop item downwards from heap index i (towards root) until proper
+ * place is found.
+ *
+ * @param h    Heap.
+ * @param i    Heap index of hole.
+ * @param item Item to place.
+ */
+static void aghp_sift_up( aghp_t h, po_size_t i, po_d item )
+{
+#ifdef AGHP_STATS
+    po_size_t const start = i;
+#endif
+
+    while ( i > AGHP_FIRST && aghp_compare( h, aghp_nth( h, i / 2 ), item ) > 0 ) {
+        aghp_nth( h, i ) = aghp_nth( h, i / 2 );
+        aghp_stat_add( h, moves, 1 );
+        i /= 2;
+    }
+
+    aghp_nth( h, i ) = item;
+    aghp_stat_add( h, moves, 1 );
+    aghp_stat_depth( h, aghp_depth( start, i ) );
+}
+
+
+/**
+ * Copy data upwards from the smaller child, starting from heap index
+ * i, until the item fits to the hole.
+ *
+ * @param h    Heap.
+ * @param i    Heap index of hole.
+ * @param item Item to place.
+ */
+static void aghp_sift_down( aghp_t h, po_size_t i, po_d item )
+{
+    po_size_t child;
+#ifdef AGHP_STATS
+    po_size_t const start = i;
+#endif
+
+    while ( i * 2 <= h->cnt ) {
+
+        /* Find the smaller child of two. */
+        child = i * 2;
+        if ( ( child != h->cnt ) &&
+             ( aghp_compare( h, aghp_nth( h, child + 1 ), aghp_nth( h, child ) ) < 0 ) )
+            child++;
+
+        /* Percolate down. */
+        if ( aghp_compare( h, item, aghp_nth( h, child ) ) > 0 )
+            aghp_nth( h, i ) = aghp_nth( h, child );
+        else
+            break;
+
+        aghp_stat_add( h, moves, 1 );
+        i = child;
+    }
+
+    aghp_nth( h, i ) = item;
+    aghp_stat_add( h, moves, 1 );
+    aghp_stat_depth( h, aghp_depth( i, start ) );
+}
@@ -71,11 +71,43 @@
  * Heapify can be used in general for priority queue operations. The
  * plain aghp_ify() is for this.
  *
+ * Heap operations can be instrumented by compiling with AGHP_STATS
+ * defined. Each heap then counts compares, item moves, operations,
+ * and the maximum number of levels an item has moved in one sift. With
+ * AGHP_STATS_CYCLES also defined, the time spent in operations is
+ * accumulated (in TSC ticks on x86-64, otherwise in ns; TSC ticks are
+ * not core cycles under frequency scaling). Counters are read with
+ * aghp_stats() and cleared with aghp_stats_reset().
+ * Without AGHP_STATS there is no instrumentation code, and
+ * aghp_stats() returns zeros. The define changes the Heap struct, so
+ * all code using Heap must be compiled with the same setting.
+ *
+ * For sort statistics, use aghp_init(), aghp_ify_for_sort() and
+ * aghp_sort() (as in aghp_sort_postor()) and read the stats of the
+ * heap.
+ *
  */
 
 
+#include <stdint.h>
 #include <postor.h>
 
+
+/**
+ * Heap statistics struct.
+ */
+struct aghp_stats_s
+{
+    po_size_t compares;  /**< Compare function calls. */
+    po_size_t moves;     /**< Item moves (writes). */
+    po_size_t ops;       /**< Operations (put, get, etc.). */
+    po_size_t max_depth; /**< Max levels moved in one sift. */
+    uint64_t  cycles;    /**< Time in operations (AGHP_STATS_CYCLES). */
+};
+
+/** Short type for Heap statistics struct. */
+typedef struct aghp_stats_s aghp_stats_s;
+
 /**
  * Heap struct.
  */
@@ -85,6 +117,9 @@ struct aghp_s
     po_compare_fn_p cmp;   /**< Compare function. */
     po_size_t       cnt;   /**< Heap item count. */
     po_pos_t        polar; /**< Polarity of heap (sm=1,gr=-1). */
+#ifdef AGHP_STATS
+    aghp_stats_s stats; /**< Statistics. */
+#endif
 };
 
 /** Short type for Heap struct. */
@@ -94,6 +129,22 @@ typedef struct aghp_s aghp_s;
 typedef struct aghp_s* aghp_t;
 
 
+/**
+ * Streaming top-K selection struct.
+ */
+struct aghp_topk_s
+{
+    aghp_s    heap; /**< Heap of selected items (inverted polarity). */
+    po_size_t k;    /**< Number of items to select. */
+};
+
+/** Short type for top-K struct. */
+typedef struct aghp_topk_s aghp_topk_s;
+
+/** Handle type for top-K. */
+typedef struct aghp_topk_s* aghp_topk_t;
+
+
 
 /**
  * Create Heap handle from Postor.
@@ -147,6 +198,20 @@ aghp_t aghp_del( aghp_t h );
 void aghp_put( aghp_t h, po_d item );
 
 
+/**
+ * Put many items to Heap.
+ *
+ * Items are appended to the Heap and the heap order is repaired
+ * once. For a large batch the Heap is rebuilt bottom-up (see
+ * aghp_ify()), otherwise each item is put separately.
+ *
+ * @param h     Heap.
+ * @param items Items.
+ * @param cnt   Item count.
+ */
+void aghp_put_many( aghp_t h, po_d* items, po_size_t cnt );
+
+
 /**
  * Get item from Heap.
  *
@@ -160,10 +225,66 @@ void aghp_put( aghp_t h, po_d item );
 po_d aghp_get( aghp_t h );
 
 
+/**
+ * Return root item without removing it.
+ *
+ * @param h Heap.
+ *
+ * @return Item (smallest/biggest), NULL if empty.
+ */
+po_d aghp_peek( aghp_t h );
+
+
+/**
+ * Put item to Heap and get root item, as one operation.
+ *
+ * If item would be the new root, it is returned as such. Otherwise
+ * the root is returned and item is dropped from root downwards. This
+ * takes at most one sift, instead of two with aghp_put() and
+ * aghp_get().
+ *
+ * @param h    Heap.
+ * @param item Item.
+ *
+ * @return Item (smallest/biggest of heap and item).
+ */
+po_d aghp_pushpop( aghp_t h, po_d item );
+
+
+/**
+ * Get root item and put item to Heap, as one operation.
+ *
+ * Item replaces the root and is dropped downwards (one sift). Note
+ * that the returned item might be worse than the given item, see
+ * aghp_pushpop().
+ *
+ * @param h    Heap.
+ * @param item Item.
+ *
+ * @return Previous root item, NULL if heap was empty.
+ */
+po_d aghp_replace( aghp_t h, po_d item );
+
+
+/**
+ * Get multiple items from Heap.
+ *
+ * Items are stored to "out" in heap order.
+ *
+ * @param h   Heap.
+ * @param n   Max number of items.
+ * @param out Item storage (space for n items).
+ *
+ * @return Number of items.
+ */
+po_size_t aghp_get_many( aghp_t h, po_size_t n, po_d* out );
+
+
 /**
  * Heapify Heap.
  *
- * The assigned Postor items are arranged into binary heap.
+ * The assigned Postor items are arranged into binary heap. Heap is
+ * built bottom-up with O(n) compares.
  *
  * @param h Heap.
  */
@@ -201,6 +322,58 @@ void aghp_sort( aghp_t h );
 void aghp_sort_postor( po_t po, po_compare_fn_p cmp, po_pos_t dir );
 
 
+/**
+ * Select K first items (in sort order) from Postor data.
+ *
+ * The result is the same as the first K items after
+ * aghp_sort_postor(), but only a K sized heap is maintained. The heap
+ * has inverted polarity, i.e. the root is the worst of the selected
+ * items and it is replaced by any better item. "po" is not modified.
+ *
+ * @param po  Postor.
+ * @param k   Number of items to select.
+ * @param cmp Data compare function.
+ * @param dir Sort polarity (1 = ascending, -1 = decending).
+ * @param out Postor for selected items in sort order (reset first).
+ */
+void aghp_topk( po_t po, po_size_t k, po_compare_fn_p cmp, po_pos_t dir, po_t out );
+
+
+/**
+ * Initialize streaming top-K selection.
+ *
+ * Items are given with aghp_topk_put() and the selection is completed
+ * with aghp_topk_done(). See aghp_topk() for details about
+ * parameters.
+ *
+ * @param t   Top-K.
+ * @param out Postor for selected items (reset first).
+ * @param k   Number of items to select.
+ * @param cmp Data compare function.
+ * @param dir Sort polarity (1 = ascending, -1 = decending).
+ */
+void aghp_topk_init( aghp_topk_t t, po_t out, po_size_t k, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Put item to top-K selection.
+ *
+ * @param t    Top-K.
+ * @param item Item.
+ */
+void aghp_topk_put( aghp_topk_t t, po_d item );
+
+
+/**
+ * Complete top-K selection.
+ *
+ * Selected items are sorted in the output Postor.
+ *
+ * @param t Top-K.
+ */
+void aghp_topk_done( aghp_topk_t t );
+
+
 /**
  * Return 1 if empty.
  *
@@ -230,6 +403,23 @@ void aghp_set_polar( aghp_t h, po_pos_t polar );
 void aghp_inv_polar( aghp_t h );
 
 
+/**
+ * Take snapshot of Heap statistics.
+ *
+ * @param h     Heap.
+ * @param stats Statistics storage (zeros without AGHP_STATS).
+ */
+void aghp_stats( aghp_t h, aghp_stats_s* stats );
+
+
+/**
+ * Reset Heap statistics.
+ *
+ * @param h Heap.
+ */
+void aghp_stats_reset( aghp_t h );
+
+
 /**
  * Return Heap polarity.
  *
@@ -0,0 +1,335 @@
+/**
+ * @file   ag_iheap.c
+ *
+ * @brief  Addressable (indexed) heap algorithms over containers.
+ */
+
+#include <string.h>
+#include "ag_iheap.h"
+
+
+/** Minimum side array size. */
+#define AGIH_MIN_SIZE 16
+
+/** Return item of handle. */
+#define agih_data( h, hnd ) ( ( ( h )->po->data )[ hnd ] )
+
+
+static int agih_compare( agih_t h, agih_handle_t a, agih_handle_t b );
+static void agih_resize( agih_t h, po_size_t size );
+static void agih_place( agih_t h, po_size_t i, agih_handle_t hnd );
+static void agih_sift_up( agih_t h, po_size_t i, agih_handle_t hnd );
+static void agih_sift_down( agih_t h, po_size_t i, agih_handle_t hnd );
+static void agih_fix( agih_t h, po_size_t i, agih_handle_t hnd );
+
+
+
+agih_t agih_new( po_t po, po_compare_fn_p cmp, po_pos_t dir )
+{
+    agih_t h;
+    h = po_malloc( sizeof( agih_s ) );
+    agih_init( h, po, cmp, dir );
+    return h;
+}
+
+
+void agih_init( agih_t h, po_t po, po_compare_fn_p cmp, po_pos_t dir )
+{
+    h->po = po;
+    h->cmp = cmp;
+    h->cnt = 0;
+    h->polar = dir;
+    h->heap = NULL;
+    h->pos = NULL;
+    h->hcnt = 0;
+    h->size = 0;
+}
+
+
+void agih_deinit( agih_t h )
+{
+    po_free( h->heap );
+    po_free( h->pos );
+    h->heap = NULL;
+    h->pos = NULL;
+    h->cnt = 0;
+    h->hcnt = 0;
+    h->size = 0;
+}
+
+
+agih_t agih_del( agih_t h )
+{
+    agih_deinit( h );
+    po_free( h );
+    return NULL;
+}
+
+
+agih_handle_t agih_put( agih_t h, po_d item )
+{
+    agih_handle_t hnd;
+
+    if ( h->cnt < h->hcnt ) {
+
+        /* Reuse released handle. */
+        hnd = h->heap[ h->cnt ];
+        agih_data( h, hnd ) = item;
+
+    } else {
+
+        hnd = h->hcnt++;
+        if ( h->hcnt > h->size )
+            agih_resize( h, h->hcnt );
+
+        if ( hnd >= h->po->used )
+            po_push( h->po, item );
+        else
+            agih_data( h, hnd ) = item;
+    }
+
+    agih_sift_up( h, h->cnt++, hnd );
+
+    return hnd;
+}
+
+
+po_d agih_get( agih_t h )
+{
+    if ( agih_is_empty( h ) )
+        return NULL;
+    else
+        return agih_remove( h, h->heap[ 0 ] );
+}
+
+
+po_d agih_peek( agih_t h )
+{
+    if ( agih_is_empty( h ) )
+        return NULL;
+    else
+        return agih_data( h, h->heap[ 0 ] );
+}
+
+
+agih_handle_t agih_top( agih_t h )
+{
+    if ( agih_is_empty( h ) )
+        return AGIH_NONE;
+    else
+        return h->heap[ 0 ];
+}
+
+
+void agih_update( agih_t h, agih_handle_t hnd, po_d item )
+{
+    agih_data( h, hnd ) = item;
+    agih_fix( h, h->pos[ hnd ], hnd );
+}
+
+
+po_d agih_remove( agih_t h, agih_handle_t hnd )
+{
+    po_size_t     i;
+    agih_handle_t last;
+
+    i = h->pos[ hnd ];
+    last = h->heap[ --h->cnt ];
+
+    /* Fill the hole with the last item. */
+    if ( i != h->cnt )
+        agih_fix( h, i, last );
+
+    /* Released handle is parked right after the active ones. */
+    agih_place( h, h->cnt, hnd );
+
+    return agih_data( h, hnd );
+}
+
+
+po_d agih_item( agih_t h, agih_handle_t hnd )
+{
+    return agih_data( h, hnd );
+}
+
+
+int agih_contains( agih_t h, agih_handle_t hnd )
+{
+    if ( hnd < h->hcnt && h->pos[ hnd ] < h->cnt )
+        return 1;
+    else
+        return 0;
+}
+
+
+void agih_ify( agih_t h )
+{
+    h->cnt = h->po->used;
+    h->hcnt = h->cnt;
+    if ( h->hcnt > h->size )
+        agih_resize( h, h->hcnt );
+
+    for ( po_size_t i = 0; i < h->cnt; i++ )
+        agih_place( h, i, i );
+
+    for ( po_size_t i = h->cnt / 2; i-- > 0; )
+        agih_sift_down( h, i, h->heap[ i ] );
+}
+
+
+po_size_t agih_cnt( agih_t h )
+{
+    return h->cnt;
+}
+
+
+int agih_is_empty( agih_t h )
+{
+    if ( h->cnt > 0 )
+        return 0;
+    else
+        return 1;
+}
+
+
+po_pos_t agih_get_polar( agih_t h )
+{
+    return h->polar;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Compare items of handles a and b and adjust the compare function
+ * result with heap polar.
+ *
+ * @param h Indexed Heap.
+ * @param a Reference handle.
+ * @param b Compare handle.
+ *
+ * @return a > b => 1, a < b => -1, a == b => 0.
+ */
+static int agih_compare( agih_t h, agih_handle_t a, agih_handle_t b )
+{
+    return h->polar * h->cmp( agih_data( h, a ), agih_data( h, b ) );
+}
+
+
+/**
+ * Resize side arrays to (at least) size.
+ *
+ * @param h    Indexed Heap.
+ * @param size Minimum size.
+ */
+static void agih_resize( agih_t h, po_size_t size )
+{
+    agih_handle_t* heap;
+    po_size_t*     pos;
+    po_size_t      new_size;
+
+    new_size = h->size < AGIH_MIN_SIZE ? AGIH_MIN_SIZE : h->size;
+    while ( new_size < size )
+        new_size *= 2;
+
+    heap = po_malloc( new_size * sizeof( agih_handle_t ) );
+    pos = po_malloc( new_size * sizeof( po_size_t ) );
+    if ( h->size > 0 ) {
+        memcpy( heap, h->heap, h->size * sizeof( agih_handle_t ) );
+        memcpy( pos, h->pos, h->size * sizeof( po_size_t ) );
+    }
+    po_free( h->heap );
+    po_free( h->pos );
+
+    h->heap = heap;
+    h->pos = pos;
+    h->size = new_size;
+}
+
+
+/**
+ * Place handle to heap position i.
+ *
+ * @param h   Indexed Heap.
+ * @param i   Heap position.
+ * @param hnd Handle.
+ */
+static void agih_place( agih_t h, po_size_t i, agih_handle_t hnd )
+{
+    h->heap[ i ] = hnd;
+    h->pos[ hnd ] = i;
+}
+
+
+/**
+ * Move parents down from position i until proper place for handle is
+ * found towards root.
+ *
+ * @param h   Indexed Heap.
+ * @param i   Heap position of hole.
+ * @param hnd Handle to place.
+ */
+static void agih_sift_up( agih_t h, po_size_t i, agih_handle_t hnd )
+{
+    po_size_t parent;
+
+    while ( i > 0 ) {
+        parent = ( i - 1 ) / 2;
+        if ( agih_compare( h, h->heap[ parent ], hnd ) <= 0 )
+            break;
+        agih_place( h, i, h->heap[ parent ] );
+        i = parent;
+    }
+
+    agih_place( h, i, hnd );
+}
+
+
+/**
+ * Move the smaller child up from position i until the handle fits to
+ * the hole.
+ *
+ * @param h   Indexed Heap.
+ * @param i   Heap position of hole.
+ * @param hnd Handle to place.
+ */
+static void agih_sift_down( agih_t h, po_size_t i, agih_handle_t hnd )
+{
+    po_size_t child;
+
+    while ( ( child = 2 * i + 1 ) < h->cnt ) {
+
+        /* Find the smaller child of two. */
+        if ( ( child + 1 < h->cnt )
+             && ( agih_compare( h, h->heap[ child + 1 ], h->heap[ child ] ) < 0 ) )
+            child++;
+
+        if ( agih_compare( h, hnd, h->heap[ child ] ) <= 0 )
+            break;
+
+        agih_place( h, i, h->heap[ child ] );
+        i = child;
+    }
+
+    agih_place( h, i, hnd );
+}
+
+
+/**
+ * Place handle to hole at position i and restore heap order in
+ * either direction.
+ *
+ * @param h   Indexed Heap.
+ * @param i   Heap position of hole.
+ * @param hnd Handle to place.
+ */
+static void agih_fix( agih_t h, po_size_t i, agih_handle_t hnd )
+{
+    if ( i > 0 && agih_compare( h, h->heap[ ( i - 1 ) / 2 ], hnd ) > 0 )
+        agih_sift_up( h, i, hnd );
+    else
+        agih_sift_down( h, i, hnd );
+}
@@ -0,0 +1,240 @@
+#ifndef AG_IHEAP_H
+#define AG_IHEAP_H
+
+/**
+ * @file   ag_iheap.h
+ *
+ * @brief  Addressable (indexed) heap algorithms over containers.
+ *
+ *
+ * Indexed Heap is a binary heap (see ag_heap.h) where each item is
+ * identified by a stable handle. agih_put() returns the handle, and
+ * the item can later be updated (re-prioritized) or removed with the
+ * handle in O(log n) time. Typical users are Dijkstra (decrease-key),
+ * LRU aging and deadline changes.
+ *
+ * Items are stored in Postor at the handle index, i.e. Postor item
+ * N is the item of handle N. Heap ordering is maintained in a side
+ * array of handles, and the heap position of each handle is
+ * maintained in another side array. Items themselves are never moved
+ * in the Postor.
+ *
+ * Side arrays hold all allocated handles: active handles are in heap
+ * positions 0 ... cnt-1 and released handles after them. Released
+ * handles are reused by agih_put(). Hence a handle is valid from
+ * agih_put() until the item leaves the heap (agih_get() or
+ * agih_remove()).
+ *
+ * Polarity is as in Heap: 1 = min at root, -1 = max at root.
+ *
+ */
+
+
+#include <postor.h>
+
+
+/** Handle type for Indexed Heap items. */
+typedef po_size_t agih_handle_t;
+
+/** Invalid handle. */
+#define AGIH_NONE ( (agih_handle_t)-1 )
+
+
+/**
+ * Indexed Heap struct.
+ */
+struct agih_s
+{
+    po_t            po;    /**< Postor (items by handle). */
+    po_compare_fn_p cmp;   /**< Compare function. */
+    po_size_t       cnt;   /**< Heap item count. */
+    po_pos_t        polar; /**< Polarity of heap (sm=1,gr=-1). */
+    agih_handle_t*  heap;  /**< Handles in heap order. */
+    po_size_t*      pos;   /**< Heap position by handle. */
+    po_size_t       hcnt;  /**< Allocated handle count. */
+    po_size_t       size;  /**< Side array size. */
+};
+
+/** Short type for Indexed Heap struct. */
+typedef struct agih_s agih_s;
+
+/** Handle type for Indexed Heap. */
+typedef struct agih_s* agih_t;
+
+
+
+/**
+ * Create Indexed Heap handle from Postor.
+ *
+ * Postor should be empty, or heapified with agih_ify().
+ *
+ * @param po  Postor.
+ * @param cmp Data compare function.
+ * @param dir Polarity (1=ascending).
+ *
+ * @return Indexed Heap.
+ */
+agih_t agih_new( po_t po, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Initialize Indexed Heap handle using Postor.
+ *
+ * @param h   Indexed Heap.
+ * @param po  Postor.
+ * @param cmp Data compare function.
+ * @param dir Polarity.
+ */
+void agih_init( agih_t h, po_t po, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Release Indexed Heap side arrays.
+ *
+ * @param h Indexed Heap.
+ */
+void agih_deinit( agih_t h );
+
+
+/**
+ * Delete Indexed Heap.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return NULL
+ */
+agih_t agih_del( agih_t h );
+
+
+/**
+ * Put item to Indexed Heap.
+ *
+ * @param h    Indexed Heap.
+ * @param item Item.
+ *
+ * @return Item handle.
+ */
+agih_handle_t agih_put( agih_t h, po_d item );
+
+
+/**
+ * Get root item from Indexed Heap.
+ *
+ * The handle of the item is released.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return Item (smallest/biggest), NULL if empty.
+ */
+po_d agih_get( agih_t h );
+
+
+/**
+ * Return root item without removing it.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return Item (smallest/biggest), NULL if empty.
+ */
+po_d agih_peek( agih_t h );
+
+
+/**
+ * Return handle of root item.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return Handle, AGIH_NONE if empty.
+ */
+agih_handle_t agih_top( agih_t h );
+
+
+/**
+ * Replace item of handle and restore heap order.
+ *
+ * Item may be the same item with modified priority (key), or a new
+ * item. Both decrease-key and increase-key are supported.
+ *
+ * @param h    Indexed Heap.
+ * @param hnd  Item handle.
+ * @param item Item.
+ */
+void agih_update( agih_t h, agih_handle_t hnd, po_d item );
+
+
+/**
+ * Remove item by handle.
+ *
+ * @param h   Indexed Heap.
+ * @param hnd Item handle.
+ *
+ * @return Removed item.
+ */
+po_d agih_remove( agih_t h, agih_handle_t hnd );
+
+
+/**
+ * Return item of handle.
+ *
+ * @param h   Indexed Heap.
+ * @param hnd Item handle.
+ *
+ * @return Item.
+ */
+po_d agih_item( agih_t h, agih_handle_t hnd );
+
+
+/**
+ * Return 1 if handle is in heap.
+ *
+ * @param h   Indexed Heap.
+ * @param hnd Item handle.
+ *
+ * @return 1 if in heap (else 0).
+ */
+int agih_contains( agih_t h, agih_handle_t hnd );
+
+
+/**
+ * Heapify Indexed Heap.
+ *
+ * The assigned Postor items are arranged into heap. Handle of each
+ * item is its Postor index.
+ *
+ * @param h Indexed Heap.
+ */
+void agih_ify( agih_t h );
+
+
+/**
+ * Return item count.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return Count.
+ */
+po_size_t agih_cnt( agih_t h );
+
+
+/**
+ * Return 1 if empty.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return 1 for empty (else 0).
+ */
+int agih_is_empty( agih_t h );
+
+
+/**
+ * Return Indexed Heap polarity.
+ *
+ * @param h Indexed Heap.
+ *
+ * @return Polarity.
+ */
+po_pos_t agih_get_polar( agih_t h );
+
+
+
+#endif
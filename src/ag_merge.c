@@ -0,0 +1,255 @@
+/**
+ * @file   ag_merge.c
+ *
+ * @brief  K-way merge of sorted sequences.
+ */
+
+#include "ag_merge.h"
+
+
+/**
+ * Postor source cursor.
+ */
+typedef struct agmg_cursor_s
+{
+    po_t      po;  /**< Postor. */
+    po_size_t pos; /**< Next position. */
+} agmg_cursor_s;
+
+
+static int agmg_beats( agmg_t m, po_size_t a, po_size_t b );
+static po_d agmg_cursor_next( void* arg );
+static void agmg_push( po_d item, void* arg );
+
+
+
+agmg_t agmg_new( agmg_source_s* src, po_size_t k, po_compare_fn_p cmp, po_pos_t dir )
+{
+    agmg_t m;
+    m = po_malloc( sizeof( agmg_s ) );
+    agmg_init( m, src, k, cmp, dir );
+    return m;
+}
+
+
+void agmg_init( agmg_t m, agmg_source_s* src, po_size_t k, po_compare_fn_p cmp, po_pos_t dir )
+{
+    po_size_t* win;
+    po_size_t  a;
+    po_size_t  b;
+
+    m->src = src;
+    m->k = k;
+    m->cmp = cmp;
+    m->polar = dir;
+    m->head = po_malloc( ( k + 1 ) * sizeof( po_d ) );
+    m->tree = po_malloc( ( k + 1 ) * sizeof( po_size_t ) );
+
+    for ( po_size_t s = 0; s < k; s++ )
+        m->head[ s ] = src[ s ].next( src[ s ].arg );
+
+    if ( k < 2 ) {
+        /* Single (or no) source is the winner as such. */
+        m->head[ k ] = NULL;
+        m->tree[ 0 ] = 0;
+        return;
+    }
+
+    /*
+     * Play the initial tournament bottom-up. Leaves are at k ... 2k-1
+     * and internal nodes at 1 ... k-1 (heap indexing).
+     */
+    win = po_malloc( 2 * k * sizeof( po_size_t ) );
+
+    for ( po_size_t s = 0; s < k; s++ )
+        win[ k + s ] = s;
+
+    for ( po_size_t i = k - 1; i >= 1; i-- ) {
+        a = win[ 2 * i ];
+        b = win[ 2 * i + 1 ];
+        if ( agmg_beats( m, a, b ) ) {
+            win[ i ] = a;
+            m->tree[ i ] = b;
+        } else {
+            win[ i ] = b;
+            m->tree[ i ] = a;
+        }
+    }
+
+    m->tree[ 0 ] = win[ 1 ];
+
+    po_free( win );
+}
+
+
+void agmg_deinit( agmg_t m )
+{
+    po_free( m->head );
+    po_free( m->tree );
+    m->head = NULL;
+    m->tree = NULL;
+}
+
+
+agmg_t agmg_del( agmg_t m )
+{
+    agmg_deinit( m );
+    po_free( m );
+    return NULL;
+}
+
+
+po_d agmg_get( agmg_t m )
+{
+    po_size_t w;
+    po_size_t node;
+    po_size_t tmp;
+    po_d      item;
+
+    w = m->tree[ 0 ];
+    item = m->head[ w ];
+    if ( item == NULL || m->k == 0 )
+        return NULL;
+
+    m->head[ w ] = m->src[ w ].next( m->src[ w ].arg );
+
+    /* Replay the matches from the leaf of winner to the top. */
+    for ( node = ( w + m->k ) / 2; node > 0; node /= 2 ) {
+        if ( agmg_beats( m, m->tree[ node ], w ) ) {
+            tmp = m->tree[ node ];
+            m->tree[ node ] = w;
+            w = tmp;
+        }
+    }
+
+    m->tree[ 0 ] = w;
+
+    return item;
+}
+
+
+po_d agmg_peek( agmg_t m )
+{
+    if ( m->k == 0 )
+        return NULL;
+    else
+        return m->head[ m->tree[ 0 ] ];
+}
+
+
+po_size_t agmg_drain( agmg_t m, agmg_emit_fn_p emit, void* arg )
+{
+    po_size_t cnt;
+    po_d      item;
+
+    cnt = 0;
+    while ( ( item = agmg_get( m ) ) != NULL ) {
+        emit( item, arg );
+        cnt++;
+    }
+
+    return cnt;
+}
+
+
+void agmg_postor( po_t* in, po_size_t k, po_compare_fn_p cmp, po_pos_t dir, po_t out )
+{
+    out->used = 0;
+    agmg_postor_emit( in, k, cmp, dir, agmg_push, out );
+}
+
+
+po_size_t agmg_postor_emit( po_t*           in,
+                            po_size_t       k,
+                            po_compare_fn_p cmp,
+                            po_pos_t        dir,
+                            agmg_emit_fn_p  emit,
+                            void*           arg )
+{
+    agmg_cursor_s* cur;
+    agmg_source_s* src;
+    agmg_s         ms;
+    po_size_t      cnt;
+
+    cur = po_malloc( ( k + 1 ) * sizeof( agmg_cursor_s ) );
+    src = po_malloc( ( k + 1 ) * sizeof( agmg_source_s ) );
+
+    for ( po_size_t s = 0; s < k; s++ ) {
+        cur[ s ].po = in[ s ];
+        cur[ s ].pos = 0;
+        src[ s ].next = agmg_cursor_next;
+        src[ s ].arg = &cur[ s ];
+    }
+
+    agmg_init( &ms, src, k, cmp, dir );
+    cnt = agmg_drain( &ms, emit, arg );
+    agmg_deinit( &ms );
+
+    po_free( cur );
+    po_free( src );
+
+    return cnt;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Return 1 if source a beats (goes before) source b. Exhausted source
+ * always loses, and equal items are ordered by source index.
+ *
+ * @param m Merge.
+ * @param a Source index.
+ * @param b Source index.
+ *
+ * @return 1 if a wins (else 0).
+ */
+static int agmg_beats( agmg_t m, po_size_t a, po_size_t b )
+{
+    int res;
+
+    if ( m->head[ a ] == NULL )
+        return 0;
+    if ( m->head[ b ] == NULL )
+        return 1;
+
+    res = m->polar * m->cmp( m->head[ a ], m->head[ b ] );
+
+    if ( res < 0 || ( res == 0 && a < b ) )
+        return 1;
+    else
+        return 0;
+}
+
+
+/**
+ * Postor cursor source.
+ *
+ * @param arg Cursor.
+ *
+ * @return Next item, NULL at end.
+ */
+static po_d agmg_cursor_next( void* arg )
+{
+    agmg_cursor_s* c = (agmg_cursor_s*)arg;
+
+    if ( c->pos < c->po->used )
+        return c->po->data[ c->pos++ ];
+    else
+        return NULL;
+}
+
+
+/**
+ * Push output to Postor.
+ *
+ * @param item Item.
+ * @param arg  Postor.
+ */
+static void agmg_push( po_d item, void* arg )
+{
+    po_push( (po_t)arg, item );
+}
@@ -0,0 +1,208 @@
+#ifndef AG_MERGE_H
+#define AG_MERGE_H
+
+/**
+ * @file   ag_merge.h
+ *
+ * @brief  K-way merge of sorted sequences.
+ *
+ *
+ * Merge combines K sorted sources to one sorted stream using a loser
+ * tree (tournament tree). Each internal node of the tree holds the
+ * loser of the match between its subtrees, and the overall winner is
+ * kept at the top. When the winner is taken, the next item of the
+ * same source replays only the matches on the path to the top, i.e.
+ * log2(K) compares per item, and no moves of the other items.
+ *
+ *
+ *                   [w]             Winner (source).
+ *                    |
+ *                   [l]             Losers of matches.
+ *                 /     \
+ *              [l]       [l]
+ *             /   \     /   \
+ *           s0    s1  s2    s3      Sources (leaves).
+ *
+ *
+ * Sources are generic: a source is a "next" function with an
+ * argument, which returns the next item of the source or NULL when
+ * the source is exhausted. Hence items can't be NULL. Helpers are
+ * provided for merging sorted Postors.
+ *
+ * Compare function and polarity are as in Heap (see ag_heap.h):
+ * polarity of "1" means ascending order and "-1" decending. Each
+ * source must be sorted in the merge order. Items that compare equal
+ * are output in source order, i.e. merge is stable.
+ *
+ */
+
+
+#include <postor.h>
+
+
+/**
+ * Source next item function.
+ *
+ * @param arg Source argument.
+ *
+ * @return Next item, or NULL if source is exhausted.
+ */
+typedef po_d ( *agmg_next_fn_p )( void* arg );
+
+
+/**
+ * Output item function.
+ *
+ * @param item Item.
+ * @param arg  User argument.
+ */
+typedef void ( *agmg_emit_fn_p )( po_d item, void* arg );
+
+
+/**
+ * Merge source struct.
+ */
+struct agmg_source_s
+{
+    agmg_next_fn_p next; /**< Next item function. */
+    void*          arg;  /**< Next item function argument. */
+};
+
+/** Short type for Merge source struct. */
+typedef struct agmg_source_s agmg_source_s;
+
+
+/**
+ * Merge struct.
+ */
+struct agmg_s
+{
+    agmg_source_s*  src;   /**< Sources. */
+    po_size_t       k;     /**< Source count. */
+    po_compare_fn_p cmp;   /**< Compare function. */
+    po_pos_t        polar; /**< Polarity (sm=1,gr=-1). */
+    po_d*           head;  /**< Current item of each source. */
+    po_size_t*      tree;  /**< Loser tree (winner at 0). */
+};
+
+/** Short type for Merge struct. */
+typedef struct agmg_s agmg_s;
+
+/** Handle type for Merge. */
+typedef struct agmg_s* agmg_t;
+
+
+
+/**
+ * Create Merge from sources.
+ *
+ * The first item of each source is read.
+ *
+ * @param src Sources (referenced, not copied).
+ * @param k   Source count.
+ * @param cmp Data compare function.
+ * @param dir Polarity (1=ascending).
+ *
+ * @return Merge.
+ */
+agmg_t agmg_new( agmg_source_s* src, po_size_t k, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Initialize Merge from sources.
+ *
+ * See agmg_new() for details about parameters.
+ *
+ * @param m   Merge.
+ * @param src Sources.
+ * @param k   Source count.
+ * @param cmp Data compare function.
+ * @param dir Polarity.
+ */
+void agmg_init( agmg_t m, agmg_source_s* src, po_size_t k, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Release Merge storage.
+ *
+ * @param m Merge.
+ */
+void agmg_deinit( agmg_t m );
+
+
+/**
+ * Delete Merge.
+ *
+ * @param m Merge.
+ *
+ * @return NULL
+ */
+agmg_t agmg_del( agmg_t m );
+
+
+/**
+ * Get next item in merge order.
+ *
+ * @param m Merge.
+ *
+ * @return Item, NULL if all sources are exhausted.
+ */
+po_d agmg_get( agmg_t m );
+
+
+/**
+ * Return next item without removing it.
+ *
+ * @param m Merge.
+ *
+ * @return Item, NULL if all sources are exhausted.
+ */
+po_d agmg_peek( agmg_t m );
+
+
+/**
+ * Merge all items to callback.
+ *
+ * @param m    Merge.
+ * @param emit Output function.
+ * @param arg  Output function argument.
+ *
+ * @return Number of items.
+ */
+po_size_t agmg_drain( agmg_t m, agmg_emit_fn_p emit, void* arg );
+
+
+/**
+ * Merge sorted Postors to output Postor.
+ *
+ * @param in  Sorted Postors.
+ * @param k   Postor count.
+ * @param cmp Data compare function.
+ * @param dir Polarity (1=ascending).
+ * @param out Output Postor (reset first).
+ */
+void agmg_postor( po_t* in, po_size_t k, po_compare_fn_p cmp, po_pos_t dir, po_t out );
+
+
+/**
+ * Merge sorted Postors to callback.
+ *
+ * @param in   Sorted Postors.
+ * @param k    Postor count.
+ * @param cmp  Data compare function.
+ * @param dir  Polarity (1=ascending).
+ * @param emit Output function.
+ * @param arg  Output function argument.
+ *
+ * @return Number of items.
+ */
+po_size_t agmg_postor_emit( po_t*           in,
+                            po_size_t       k,
+                            po_compare_fn_p cmp,
+                            po_pos_t        dir,
+                            agmg_emit_fn_p  emit,
+                            void*           arg );
+
+
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @file   ag_mqueue.c
+ *
+ * @brief  Concurrent relaxed priority queue (MultiQueue).
+ */
+
+#include <stdint.h>
+#include "ag_mqueue.h"
+
+
+/** Initial sub-heap size. */
+#define AGMQ_QUEUE_SIZE 64
+
+
+/** Thread-local random state. */
+static __thread uint64_t agmq_rng_state;
+
+
+static po_size_t agmq_rand( po_size_t limit );
+
+
+
+agmq_t agmq_new( po_compare_fn_p cmp, po_pos_t dir, po_size_t queues )
+{
+    agmq_t q;
+
+    if ( queues < 1 )
+        queues = 1;
+
+    q = po_malloc( sizeof( agmq_s ) );
+    q->queue = po_malloc( queues * sizeof( agmq_queue_s ) );
+    q->qcnt = queues;
+    q->cnt = 0;
+
+    for ( po_size_t i = 0; i < queues; i++ ) {
+        pthread_mutex_init( &q->queue[ i ].lock, NULL );
+        aghp_init( &q->queue[ i ].heap, po_new_sized( NULL, AGMQ_QUEUE_SIZE ), cmp, dir );
+    }
+
+    return q;
+}
+
+
+agmq_t agmq_del( agmq_t q )
+{
+    for ( po_size_t i = 0; i < q->qcnt; i++ ) {
+        pthread_mutex_destroy( &q->queue[ i ].lock );
+        po_del( q->queue[ i ].heap.po );
+    }
+
+    po_free( q->queue );
+    po_free( q );
+
+    return NULL;
+}
+
+
+void agmq_put( agmq_t q, po_d item )
+{
+    agmq_queue_s* qu;
+
+    for ( po_size_t tries = 0;; tries++ ) {
+
+        qu = &q->queue[ agmq_rand( q->qcnt ) ];
+
+        if ( tries >= q->qcnt ) {
+            /* Heavy contention: wait for the lock. */
+            pthread_mutex_lock( &qu->lock );
+            break;
+        }
+
+        if ( pthread_mutex_trylock( &qu->lock ) == 0 )
+            break;
+    }
+
+    /*
+     * Count is updated with the sub-heap lock held (also in get),
+     * hence a non-zero count means that there is an item to get.
+     */
+    aghp_put( &qu->heap, item );
+    __atomic_add_fetch( &q->cnt, 1, __ATOMIC_RELAXED );
+    pthread_mutex_unlock( &qu->lock );
+}
+
+
+po_d agmq_get( agmq_t q )
+{
+    agmq_queue_s* a;
+    agmq_queue_s* b;
+    po_d          ta;
+    po_d          tb;
+    po_d          item;
+
+    if ( q->qcnt == 1 ) {
+        a = &q->queue[ 0 ];
+        pthread_mutex_lock( &a->lock );
+        item = aghp_get( &a->heap );
+        if ( item )
+            __atomic_sub_fetch( &q->cnt, 1, __ATOMIC_RELAXED );
+        pthread_mutex_unlock( &a->lock );
+        return item;
+    }
+
+    for ( po_size_t tries = 0;; tries++ ) {
+
+        if ( __atomic_load_n( &q->cnt, __ATOMIC_RELAXED ) == 0 )
+            return NULL;
+
+        if ( tries >= 4 * q->qcnt ) {
+
+            /*
+             * Few non-empty sub-heaps, or heavy contention: scan all
+             * sub-heaps in order and take the first item found.
+             */
+            for ( po_size_t i = 0; i < q->qcnt; i++ ) {
+                a = &q->queue[ i ];
+                pthread_mutex_lock( &a->lock );
+                item = aghp_get( &a->heap );
+                if ( item )
+                    __atomic_sub_fetch( &q->cnt, 1, __ATOMIC_RELAXED );
+                pthread_mutex_unlock( &a->lock );
+                if ( item )
+                    return item;
+            }
+
+            tries = 0;
+            continue;
+        }
+
+        /* Two distinct random sub-heaps. */
+        a = &q->queue[ agmq_rand( q->qcnt ) ];
+        b = &q->queue[ agmq_rand( q->qcnt - 1 ) ];
+        if ( b >= a )
+            b++;
+
+        if ( pthread_mutex_trylock( &a->lock ) != 0 )
+            continue;
+        if ( pthread_mutex_trylock( &b->lock ) != 0 ) {
+            pthread_mutex_unlock( &a->lock );
+            continue;
+        }
+
+        ta = aghp_peek( &a->heap );
+        tb = aghp_peek( &b->heap );
+
+        item = NULL;
+        if ( ta && ( tb == NULL || a->heap.polar * a->heap.cmp( ta, tb ) <= 0 ) )
+            item = aghp_get( &a->heap );
+        else if ( tb )
+            item = aghp_get( &b->heap );
+
+        if ( item )
+            __atomic_sub_fetch( &q->cnt, 1, __ATOMIC_RELAXED );
+
+        pthread_mutex_unlock( &b->lock );
+        pthread_mutex_unlock( &a->lock );
+
+        if ( item )
+            return item;
+    }
+}
+
+
+po_size_t agmq_cnt( agmq_t q )
+{
+    return __atomic_load_n( &q->cnt, __ATOMIC_RELAXED );
+}
+
+
+int agmq_is_empty( agmq_t q )
+{
+    if ( agmq_cnt( q ) > 0 )
+        return 0;
+    else
+        return 1;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Return random number below limit (xorshift64*).
+ *
+ * @param limit Limit.
+ *
+ * @return Random number.
+ */
+static po_size_t agmq_rand( po_size_t limit )
+{
+    uint64_t x;
+
+    x = agmq_rng_state;
+    if ( x == 0 ) {
+        /* Seed from the thread-local address, which is per thread. */
+        x = (uint64_t)(uintptr_t)&agmq_rng_state * 0x9E3779B97F4A7C15ULL + 1;
+    }
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    agmq_rng_state = x;
+
+    return (po_size_t)( ( ( x * 0x2545F4914F6CDD1DULL ) >> 32 ) % limit );
+}
@@ -0,0 +1,158 @@
+#ifndef AG_MQUEUE_H
+#define AG_MQUEUE_H
+
+/**
+ * @file   ag_mqueue.h
+ *
+ * @brief  Concurrent relaxed priority queue (MultiQueue).
+ *
+ *
+ * MultiQueue is a priority queue for multiple threads. It consists
+ * of several sub-heaps (see ag_heap.h), each protected by its own
+ * mutex. There is no global lock:
+ *
+ * - Put: item is put to a randomly selected sub-heap, which is
+ *   locked with trylock. If the lock is busy, another sub-heap is
+ *   tried.
+ *
+ * - Get: two randomly selected sub-heaps are locked with trylock, and
+ *   the better of their top items is taken. If either lock is busy,
+ *   another pair is tried.
+ *
+ * The number of sub-heaps should be a few times the number of
+ * threads (e.g. 2x), so that lock contention is rare.
+ *
+ * Ordering guarantees are relaxed:
+ *
+ * - agmq_get() returns the better of the two top items it sees, not
+ *   necessarily the globally best item. In practice the returned
+ *   item is among the best O(queues) items (rank error), and
+ *   starvation of an item is unlikely since each sub-heap is visited
+ *   with equal probability.
+ *
+ * - Items that compare equal are returned in no particular order.
+ *
+ * - An item is visible to all threads when agmq_put() has returned.
+ *
+ * - agmq_get() returns NULL only if the queue was empty at some
+ *   point during the call. Concurrent puts may make it non-empty
+ *   right after.
+ *
+ * - Item count is updated when the item is in (or out of) a
+ *   sub-heap, with the sub-heap lock held. agmq_get() keeps searching
+ *   only while the count shows items that it can find.
+ *
+ * - With one sub-heap (or one thread and one sub-heap), the order is
+ *   exact, as in Heap.
+ *
+ * Random numbers are from a thread-local xorshift generator.
+ *
+ */
+
+
+#include <pthread.h>
+#include <postor.h>
+#include "ag_heap.h"
+
+
+/**
+ * MultiQueue sub-heap.
+ */
+struct agmq_queue_s
+{
+    pthread_mutex_t lock;      /**< Sub-heap lock. */
+    aghp_s          heap;      /**< Sub-heap. */
+    char            pad[ 64 ]; /**< Separation of sub-heaps (cache line). */
+};
+
+/** Short type for MultiQueue sub-heap. */
+typedef struct agmq_queue_s agmq_queue_s;
+
+
+/**
+ * MultiQueue struct.
+ */
+struct agmq_s
+{
+    agmq_queue_s* queue; /**< Sub-heaps. */
+    po_size_t     qcnt;  /**< Sub-heap count. */
+    po_size_t     cnt;   /**< Item count (atomic). */
+};
+
+/** Short type for MultiQueue struct. */
+typedef struct agmq_s agmq_s;
+
+/** Handle type for MultiQueue. */
+typedef struct agmq_s* agmq_t;
+
+
+
+/**
+ * Create MultiQueue.
+ *
+ * Compare function and polarity are as in Heap.
+ *
+ * @param cmp    Data compare function.
+ * @param dir    Polarity (1=ascending).
+ * @param queues Number of sub-heaps (min 1).
+ *
+ * @return MultiQueue.
+ */
+agmq_t agmq_new( po_compare_fn_p cmp, po_pos_t dir, po_size_t queues );
+
+
+/**
+ * Delete MultiQueue.
+ *
+ * Must not be used concurrently.
+ *
+ * @param q MultiQueue.
+ *
+ * @return NULL
+ */
+agmq_t agmq_del( agmq_t q );
+
+
+/**
+ * Put item to MultiQueue.
+ *
+ * @param q    MultiQueue.
+ * @param item Item.
+ */
+void agmq_put( agmq_t q, po_d item );
+
+
+/**
+ * Get (approximately) best item from MultiQueue.
+ *
+ * @param q MultiQueue.
+ *
+ * @return Item, NULL if empty.
+ */
+po_d agmq_get( agmq_t q );
+
+
+/**
+ * Return item count.
+ *
+ * Count is exact only when there are no concurrent operations.
+ *
+ * @param q MultiQueue.
+ *
+ * @return Count.
+ */
+po_size_t agmq_cnt( agmq_t q );
+
+
+/**
+ * Return 1 if empty.
+ *
+ * @param q MultiQueue.
+ *
+ * @return 1 for empty (else 0).
+ */
+int agmq_is_empty( agmq_t q );
+
+
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file   ag_rheap.c
+ *
+ * @brief  Radix heap, monotone integer priority queue.
+ */
+
+#include "ag_rheap.h"
+
+
+/** Initial bucket size. */
+#define AGRH_BUCKET_SIZE 16
+
+
+static po_size_t agrh_bucket( uint64_t last, uint64_t key );
+static void agrh_pull( agrh_t h );
+
+
+
+agrh_t agrh_new( agrh_key_fn_p key )
+{
+    agrh_t h;
+    h = po_malloc( sizeof( agrh_s ) );
+    agrh_init( h, key );
+    return h;
+}
+
+
+void agrh_init( agrh_t h, agrh_key_fn_p key )
+{
+    for ( int i = 0; i < AGRH_BUCKETS; i++ )
+        h->bucket[ i ] = po_new_sized( NULL, AGRH_BUCKET_SIZE );
+    h->key = key;
+    h->last = 0;
+    h->cnt = 0;
+}
+
+
+void agrh_deinit( agrh_t h )
+{
+    for ( int i = 0; i < AGRH_BUCKETS; i++ )
+        h->bucket[ i ] = po_del( h->bucket[ i ] );
+    h->cnt = 0;
+}
+
+
+agrh_t agrh_del( agrh_t h )
+{
+    agrh_deinit( h );
+    po_free( h );
+    return NULL;
+}
+
+
+int agrh_put( agrh_t h, po_d item )
+{
+    uint64_t key;
+
+    key = h->key( item );
+
+    /* Smaller key would break the bucket order. */
+    if ( key < h->last )
+        return -1;
+
+    po_push( h->bucket[ agrh_bucket( h->last, key ) ], item );
+    h->cnt++;
+
+    return 0;
+}
+
+
+po_d agrh_get( agrh_t h )
+{
+    po_t b;
+
+    if ( agrh_is_empty( h ) )
+        return NULL;
+
+    agrh_pull( h );
+
+    b = h->bucket[ 0 ];
+    h->cnt--;
+    return b->data[ --b->used ];
+}
+
+
+po_d agrh_peek( agrh_t h )
+{
+    po_t      b;
+    po_size_t i;
+    po_d      item;
+    uint64_t  min;
+    uint64_t  key;
+
+    if ( agrh_is_empty( h ) )
+        return NULL;
+
+    /*
+     * Buckets are not redistributed, since that would raise "last"
+     * above the key of the last returned item.
+     */
+    for ( i = 0; h->bucket[ i ]->used == 0; i++ )
+        ;
+
+    b = h->bucket[ i ];
+    item = b->data[ b->used - 1 ];
+
+    if ( i > 0 ) {
+        min = h->key( item );
+        for ( po_size_t j = 0; j + 1 < b->used; j++ ) {
+            key = h->key( b->data[ j ] );
+            if ( key < min ) {
+                min = key;
+                item = b->data[ j ];
+            }
+        }
+    }
+
+    return item;
+}
+
+
+uint64_t agrh_last( agrh_t h )
+{
+    return h->last;
+}
+
+
+po_size_t agrh_cnt( agrh_t h )
+{
+    return h->cnt;
+}
+
+
+int agrh_is_empty( agrh_t h )
+{
+    if ( h->cnt > 0 )
+        return 0;
+    else
+        return 1;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Return bucket index for key, i.e. the index of the highest bit
+ * where key differs from last (plus one).
+ *
+ * @param last Last returned key.
+ * @param key  Item key.
+ *
+ * @return Bucket index.
+ */
+static po_size_t agrh_bucket( uint64_t last, uint64_t key )
+{
+    if ( key == last )
+        return 0;
+    else
+        return 64 - __builtin_clzll( key ^ last );
+}
+
+
+/**
+ * Make sure that bucket 0 is non-empty. Heap must not be empty.
+ *
+ * @param h Radix Heap.
+ */
+static void agrh_pull( agrh_t h )
+{
+    po_t      b;
+    po_size_t i;
+    uint64_t  min;
+    uint64_t  key;
+
+    if ( h->bucket[ 0 ]->used > 0 )
+        return;
+
+    for ( i = 1; h->bucket[ i ]->used == 0; i++ )
+        ;
+
+    b = h->bucket[ i ];
+
+    /* Minimum of bucket becomes the new last. */
+    min = h->key( b->data[ 0 ] );
+    for ( po_size_t j = 1; j < b->used; j++ ) {
+        key = h->key( b->data[ j ] );
+        if ( key < min )
+            min = key;
+    }
+    h->last = min;
+
+    /* All items move to lower buckets. */
+    for ( po_size_t j = 0; j < b->used; j++ )
+        po_push( h->bucket[ agrh_bucket( min, h->key( b->data[ j ] ) ) ],
+                 b->data[ j ] );
+    b->used = 0;
+}
@@ -0,0 +1,176 @@
+#ifndef AG_RHEAP_H
+#define AG_RHEAP_H
+
+/**
+ * @file   ag_rheap.h
+ *
+ * @brief  Radix heap, monotone integer priority queue.
+ *
+ *
+ * Radix Heap is a min-at-root priority queue for unsigned 64-bit
+ * keys, with the restriction that keys are monotone: a put key must
+ * not be smaller than the key of the last item returned by
+ * agrh_get(), otherwise agrh_put() rejects the item. Timer
+ * timestamps are a typical example.
+ *
+ * Items are kept in 65 buckets (Postors). Bucket 0 holds items with
+ * key equal to the last returned key ("last"), and bucket B holds
+ * items whose key differs from "last" first at bit B-1 (counting
+ * from LSB). When bucket 0 is empty, the first non-empty bucket is
+ * scanned for its minimum, "last" is updated, and the bucket items
+ * are redistributed to lower buckets. Each item moves down at most
+ * 64 times, hence get is amortized O(log C), where C is the key
+ * range, put is O(1), and no compare function is needed.
+ *
+ * The key of an item is read with the user provided key function.
+ *
+ */
+
+
+#include <stdint.h>
+#include <postor.h>
+
+
+/** Bucket count of Radix Heap. */
+#define AGRH_BUCKETS 65
+
+
+/**
+ * Item key function.
+ *
+ * @param item Item.
+ *
+ * @return Key of item.
+ */
+typedef uint64_t ( *agrh_key_fn_p )( const po_d item );
+
+
+/**
+ * Radix Heap struct.
+ */
+struct agrh_s
+{
+    po_t          bucket[ AGRH_BUCKETS ]; /**< Buckets. */
+    agrh_key_fn_p key;                    /**< Key function. */
+    uint64_t      last;                   /**< Last returned key. */
+    po_size_t     cnt;                    /**< Heap item count. */
+};
+
+/** Short type for Radix Heap struct. */
+typedef struct agrh_s agrh_s;
+
+/** Handle type for Radix Heap. */
+typedef struct agrh_s* agrh_t;
+
+
+
+/**
+ * Create Radix Heap.
+ *
+ * @param key Item key function.
+ *
+ * @return Radix Heap.
+ */
+agrh_t agrh_new( agrh_key_fn_p key );
+
+
+/**
+ * Initialize Radix Heap.
+ *
+ * @param h   Radix Heap.
+ * @param key Item key function.
+ */
+void agrh_init( agrh_t h, agrh_key_fn_p key );
+
+
+/**
+ * Release Radix Heap buckets.
+ *
+ * @param h Radix Heap.
+ */
+void agrh_deinit( agrh_t h );
+
+
+/**
+ * Delete Radix Heap.
+ *
+ * @param h Radix Heap.
+ *
+ * @return NULL
+ */
+agrh_t agrh_del( agrh_t h );
+
+
+/**
+ * Put item to Radix Heap.
+ *
+ * Item key must be at least the key of last returned item (see
+ * agrh_last()). Item with smaller key is rejected, and heap is not
+ * changed.
+ *
+ * @param h    Radix Heap.
+ * @param item Item.
+ *
+ * @return 0 on success, -1 if key is smaller than agrh_last().
+ */
+int agrh_put( agrh_t h, po_d item );
+
+
+/**
+ * Get item with smallest key from Radix Heap.
+ *
+ * @param h Radix Heap.
+ *
+ * @return Item, NULL if empty.
+ */
+po_d agrh_get( agrh_t h );
+
+
+/**
+ * Return item with smallest key without removing it.
+ *
+ * Peek does not change the heap, i.e. agrh_last() is not updated. If
+ * there is no item with the last returned key, the first non-empty
+ * bucket is scanned for its minimum. agrh_get() returns an item with
+ * the same key, but not necessarily the same item.
+ *
+ * @param h Radix Heap.
+ *
+ * @return Item, NULL if empty.
+ */
+po_d agrh_peek( agrh_t h );
+
+
+/**
+ * Return the smallest key allowed for agrh_put(), i.e. the key of the
+ * last item returned by agrh_get() (0 initially).
+ *
+ * @param h Radix Heap.
+ *
+ * @return Key.
+ */
+uint64_t agrh_last( agrh_t h );
+
+
+/**
+ * Return item count.
+ *
+ * @param h Radix Heap.
+ *
+ * @return Count.
+ */
+po_size_t agrh_cnt( agrh_t h );
+
+
+/**
+ * Return 1 if empty.
+ *
+ * @param h Radix Heap.
+ *
+ * @return 1 for empty (else 0).
+ */
+int agrh_is_empty( agrh_t h );
+
+
+
+#endif
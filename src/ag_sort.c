@@ -0,0 +1,592 @@
+/**
+ * @file   ag_sort.c
+ *
+ * @brief  Sorting algorithms over containers.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "ag_sort.h"
+#include "ag_heap.h"
+
+
+/** Partition size limit for ninther pivot. */
+#define AGST_NINTHER_LIMIT 128
+
+
+/**
+ * Sort context.
+ */
+typedef struct agst_ctx_s
+{
+    po_compare_fn_p cmp;   /**< Compare function. */
+    po_pos_t        polar; /**< Polarity. */
+} agst_ctx_s;
+
+/** Handle type for sort context. */
+typedef agst_ctx_s* agst_ctx_t;
+
+
+/**
+ * Radix sort entry.
+ */
+typedef struct agst_radix_s
+{
+    uint64_t key;  /**< Item key. */
+    po_d     item; /**< Item. */
+} agst_radix_s;
+
+
+/**
+ * Parallel sort worker.
+ */
+typedef struct agst_work_s
+{
+    agst_ctx_s ctx;     /**< Sort context. */
+    po_d*      src;     /**< Source data. */
+    po_d*      dst;     /**< Destination data. */
+    po_size_t* bounds;  /**< Run boundaries (runs + 1). */
+    po_size_t  runs;    /**< Number of sorted runs. */
+    po_size_t  first;   /**< First position of worker. */
+    po_size_t  last;    /**< Last position of worker (exclusive). */
+    pthread_t  tid;     /**< Worker thread. */
+    int        started; /**< Worker thread started. */
+} agst_work_s;
+
+
+/** Swap data items. */
+#define agst_swap( a, b ) \
+    do {                  \
+        po_d t_ = ( a );  \
+        ( a ) = ( b );    \
+        ( b ) = t_;       \
+    } while ( 0 )
+
+
+static int agst_compare( agst_ctx_t ctx, const po_d a, const po_d b );
+static int agst_presorted( agst_ctx_t ctx, po_d* data, po_size_t cnt );
+static void agst_insertion( agst_ctx_t ctx, po_d* data, po_size_t cnt );
+static void agst_heapsort( agst_ctx_t ctx, po_d* data, po_size_t cnt );
+static void agst_sort3( agst_ctx_t ctx, po_d* data, po_size_t a, po_size_t b, po_size_t c );
+static po_size_t agst_partition( agst_ctx_t ctx, po_d* data, po_size_t cnt );
+static void agst_intro( agst_ctx_t ctx, po_d* data, po_size_t cnt, int depth );
+static void* agst_sort_worker( void* arg );
+static void* agst_merge_worker( void* arg );
+static void agst_run( agst_work_s* work, int threads, void* ( *fn )( void* ) );
+static po_size_t agst_merge_path(
+    agst_ctx_t ctx, po_d* a, po_size_t la, po_d* b, po_size_t lb, po_size_t d );
+
+
+
+void agst_sort( po_t po, po_compare_fn_p cmp, po_pos_t dir )
+{
+    agst_sort_array( po->data, po->used, cmp, dir );
+}
+
+
+void agst_sort_array( po_d* data, po_size_t cnt, po_compare_fn_p cmp, po_pos_t dir )
+{
+    agst_ctx_s ctx;
+    int        depth;
+
+    ctx.cmp = cmp;
+    ctx.polar = dir;
+
+    if ( cnt < 2 || agst_presorted( &ctx, data, cnt ) )
+        return;
+
+    depth = 0;
+    for ( po_size_t n = cnt; n > 1; n >>= 1 )
+        depth += 2;
+
+    agst_intro( &ctx, data, cnt, depth );
+}
+
+
+
+void agst_sort_parallel(
+    po_t po, po_compare_fn_p cmp, po_pos_t dir, int threads, po_size_t cutoff )
+{
+    po_size_t const cnt = po->used;
+    agst_work_s*    work;
+    po_size_t*      bounds;
+    po_d*           scratch;
+    po_d*           src;
+    po_d*           dst;
+    po_d*           tmp;
+    po_size_t       runs;
+
+    if ( threads < 2 || cnt < cutoff || cnt < (po_size_t)threads ) {
+        agst_sort( po, cmp, dir );
+        return;
+    }
+
+    work = po_malloc( (size_t)threads * sizeof( agst_work_s ) );
+    bounds = po_malloc( ( (size_t)threads + 1 ) * sizeof( po_size_t ) );
+    scratch = po_malloc( cnt * sizeof( po_d ) );
+
+    if ( work == NULL || bounds == NULL || scratch == NULL ) {
+        po_free( work );
+        po_free( bounds );
+        po_free( scratch );
+        agst_sort( po, cmp, dir );
+        return;
+    }
+
+    runs = (po_size_t)threads;
+    for ( po_size_t r = 0; r <= runs; r++ )
+        bounds[ r ] = cnt * r / runs;
+
+    src = po->data;
+    dst = scratch;
+
+    for ( int t = 0; t < threads; t++ ) {
+        work[ t ].ctx.cmp = cmp;
+        work[ t ].ctx.polar = dir;
+        work[ t ].bounds = bounds;
+        work[ t ].first = cnt * (po_size_t)t / (po_size_t)threads;
+        work[ t ].last = cnt * (po_size_t)( t + 1 ) / (po_size_t)threads;
+    }
+
+    /* Sort each run. */
+    for ( int t = 0; t < threads; t++ )
+        work[ t ].src = src;
+    agst_run( work, threads, agst_sort_worker );
+
+    /* Merge pairs of runs until one is left. */
+    while ( runs > 1 ) {
+
+        for ( int t = 0; t < threads; t++ ) {
+            work[ t ].src = src;
+            work[ t ].dst = dst;
+            work[ t ].runs = runs;
+        }
+        agst_run( work, threads, agst_merge_worker );
+
+        for ( po_size_t r = 0; 2 * r < runs; r++ )
+            bounds[ r ] = bounds[ 2 * r ];
+        runs = ( runs + 1 ) / 2;
+        bounds[ runs ] = cnt;
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if ( src != po->data )
+        memcpy( po->data, src, cnt * sizeof( po_d ) );
+
+    po_free( work );
+    po_free( bounds );
+    po_free( scratch );
+}
+
+
+
+int agst_radix( po_t po, agst_key_fn_p key, po_pos_t dir )
+{
+    po_size_t const cnt = po->used;
+    agst_radix_s*   src;
+    agst_radix_s*   dst;
+    agst_radix_s*   tmp;
+    po_size_t       hist[ 8 ][ 256 ];
+    po_size_t       pos[ 256 ];
+    po_size_t       sum;
+    uint64_t        k;
+    uint64_t        flip;
+    int             shift;
+
+    if ( cnt < 2 )
+        return 0;
+
+    src = po_malloc( 2 * cnt * sizeof( agst_radix_s ) );
+    if ( src == NULL )
+        return -1;
+    dst = src + cnt;
+
+    /* Decending order is ascending order of inverted keys. */
+    flip = dir < 0 ? ~(uint64_t)0 : 0;
+
+    /* Extract keys and collect histograms of all passes. */
+    memset( hist, 0, sizeof( hist ) );
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        k = key( po->data[ i ] ) ^ flip;
+        src[ i ].key = k;
+        src[ i ].item = po->data[ i ];
+        for ( int b = 0; b < 8; b++ )
+            hist[ b ][ ( k >> ( 8 * b ) ) & 0xff ]++;
+    }
+
+    for ( int b = 0; b < 8; b++ ) {
+
+        shift = 8 * b;
+
+        /* All items have the same byte, order is not changed. */
+        if ( hist[ b ][ ( src[ 0 ].key >> shift ) & 0xff ] == cnt )
+            continue;
+
+        sum = 0;
+        for ( int d = 0; d < 256; d++ ) {
+            pos[ d ] = sum;
+            sum += hist[ b ][ d ];
+        }
+
+        for ( po_size_t i = 0; i < cnt; i++ )
+            dst[ pos[ ( src[ i ].key >> shift ) & 0xff ]++ ] = src[ i ];
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    for ( po_size_t i = 0; i < cnt; i++ )
+        po->data[ i ] = src[ i ].item;
+
+    po_free( src < dst ? src : dst );
+
+    return 0;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Compare a to b and adjust the compare function result with
+ * polarity.
+ *
+ * @param ctx Sort context.
+ * @param a   Reference data.
+ * @param b   Compare data.
+ *
+ * @return a > b => 1, a < b => -1, a == b => 0.
+ */
+static int agst_compare( agst_ctx_t ctx, const po_d a, const po_d b )
+{
+    return ctx->polar * ctx->cmp( a, b );
+}
+
+
+/**
+ * Check for presorted and reversed data. Reversed data is reversed
+ * in place.
+ *
+ * @param ctx  Sort context.
+ * @param data Data array.
+ * @param cnt  Data count.
+ *
+ * @return 1 if data is sorted after the check (else 0).
+ */
+static int agst_presorted( agst_ctx_t ctx, po_d* data, po_size_t cnt )
+{
+    po_size_t i;
+
+    if ( agst_compare( ctx, data[ 0 ], data[ 1 ] ) <= 0 ) {
+
+        for ( i = 2; i < cnt && agst_compare( ctx, data[ i - 1 ], data[ i ] ) <= 0; i++ )
+            ;
+        if ( i == cnt )
+            return 1;
+
+    } else {
+
+        for ( i = 2; i < cnt && agst_compare( ctx, data[ i - 1 ], data[ i ] ) >= 0; i++ )
+            ;
+        if ( i == cnt ) {
+            for ( po_size_t lo = 0, hi = cnt - 1; lo < hi; lo++, hi-- )
+                agst_swap( data[ lo ], data[ hi ] );
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * Sort small data array with insertion sort.
+ *
+ * @param ctx  Sort context.
+ * @param data Data array.
+ * @param cnt  Data count.
+ */
+static void agst_insertion( agst_ctx_t ctx, po_d* data, po_size_t cnt )
+{
+    po_d      item;
+    po_size_t j;
+
+    for ( po_size_t i = 1; i < cnt; i++ ) {
+        item = data[ i ];
+        for ( j = i; j > 0 && agst_compare( ctx, data[ j - 1 ], item ) > 0; j-- )
+            data[ j ] = data[ j - 1 ];
+        data[ j ] = item;
+    }
+}
+
+
+/**
+ * Sort data array with Heap sort.
+ *
+ * Heap is operated on a Postor view to the data array.
+ *
+ * @param ctx  Sort context.
+ * @param data Data array.
+ * @param cnt  Data count.
+ */
+static void agst_heapsort( agst_ctx_t ctx, po_d* data, po_size_t cnt )
+{
+    po_s view = { 0 };
+
+    view.data = data;
+    view.used = cnt;
+
+    aghp_sort_postor( &view, ctx->cmp, ctx->polar );
+}
+
+
+/**
+ * Order three items (by index).
+ *
+ * @param ctx  Sort context.
+ * @param data Data array.
+ * @param a    First index.
+ * @param b    Second index.
+ * @param c    Third index.
+ */
+static void agst_sort3( agst_ctx_t ctx, po_d* data, po_size_t a, po_size_t b, po_size_t c )
+{
+    if ( agst_compare( ctx, data[ a ], data[ b ] ) > 0 )
+        agst_swap( data[ a ], data[ b ] );
+    if ( agst_compare( ctx, data[ b ], data[ c ] ) > 0 )
+        agst_swap( data[ b ], data[ c ] );
+    if ( agst_compare( ctx, data[ a ], data[ b ] ) > 0 )
+        agst_swap( data[ a ], data[ b ] );
+}
+
+
+/**
+ * Select pivot and partition data array around it.
+ *
+ * Scanning stops at items equal to pivot, hence many equal items are
+ * split evenly.
+ *
+ * @param ctx  Sort context.
+ * @param data Data array.
+ * @param cnt  Data count.
+ *
+ * @return Pivot index.
+ */
+static po_size_t agst_partition( agst_ctx_t ctx, po_d* data, po_size_t cnt )
+{
+    po_size_t mid;
+    po_size_t i;
+    po_size_t j;
+    po_d      pivot;
+
+    mid = cnt / 2;
+
+    if ( cnt > AGST_NINTHER_LIMIT ) {
+        po_size_t s = cnt / 8;
+        agst_sort3( ctx, data, 0, s, 2 * s );
+        agst_sort3( ctx, data, mid - s, mid, mid + s );
+        agst_sort3( ctx, data, cnt - 1 - 2 * s, cnt - 1 - s, cnt - 1 );
+        agst_sort3( ctx, data, s, mid, cnt - 1 - s );
+    } else {
+        agst_sort3( ctx, data, 0, mid, cnt - 1 );
+    }
+
+    /* Pivot to front. */
+    agst_swap( data[ 0 ], data[ mid ] );
+    pivot = data[ 0 ];
+
+    i = 0;
+    j = cnt;
+    for ( ;; ) {
+        do
+            i++;
+        while ( i < cnt && agst_compare( ctx, data[ i ], pivot ) < 0 );
+        do
+            j--;
+        while ( agst_compare( ctx, data[ j ], pivot ) > 0 );
+        if ( i >= j )
+            break;
+        agst_swap( data[ i ], data[ j ] );
+    }
+
+    agst_swap( data[ 0 ], data[ j ] );
+
+    return j;
+}
+
+
+/**
+ * Introsort data array.
+ *
+ * @param ctx   Sort context.
+ * @param data  Data array.
+ * @param cnt   Data count.
+ * @param depth Partitioning depth left.
+ */
+static void agst_intro( agst_ctx_t ctx, po_d* data, po_size_t cnt, int depth )
+{
+    po_size_t p;
+
+    while ( cnt > AGST_INSERT_LIMIT ) {
+
+        if ( depth-- == 0 ) {
+            agst_heapsort( ctx, data, cnt );
+            return;
+        }
+
+        p = agst_partition( ctx, data, cnt );
+
+        /* Recurse to the smaller side, iterate the larger. */
+        if ( p < cnt - p - 1 ) {
+            agst_intro( ctx, data, p, depth );
+            data += p + 1;
+            cnt -= p + 1;
+        } else {
+            agst_intro( ctx, data + p + 1, cnt - p - 1, depth );
+            cnt = p;
+        }
+    }
+
+    agst_insertion( ctx, data, cnt );
+}
+
+
+/**
+ * Sort the run of worker.
+ *
+ * @param arg Worker.
+ *
+ * @return NULL
+ */
+static void* agst_sort_worker( void* arg )
+{
+    agst_work_s* w = (agst_work_s*)arg;
+
+    agst_sort_array( w->src + w->first, w->last - w->first, w->ctx.cmp, w->ctx.polar );
+
+    return NULL;
+}
+
+
+/**
+ * Produce the output positions of worker by merging pairs of runs.
+ *
+ * @param arg Worker.
+ *
+ * @return NULL
+ */
+static void* agst_merge_worker( void* arg )
+{
+    agst_work_s* w = (agst_work_s*)arg;
+    po_size_t    base;
+    po_size_t    mid;
+    po_size_t    end;
+    po_size_t    lo;
+    po_size_t    hi;
+    po_size_t    i;
+    po_size_t    j;
+    po_size_t    ie;
+    po_size_t    je;
+    po_d*        a;
+    po_d*        b;
+    po_d*        out;
+
+    for ( po_size_t r = 0; r < w->runs; r += 2 ) {
+
+        base = w->bounds[ r ];
+        mid = w->bounds[ r + 1 ];
+        end = r + 2 <= w->runs ? w->bounds[ r + 2 ] : mid;
+
+        lo = w->first > base ? w->first : base;
+        hi = w->last < end ? w->last : end;
+        if ( lo >= hi )
+            continue;
+
+        a = w->src + base;
+        b = w->src + mid;
+        out = w->dst + lo;
+
+        /* Split points of the pair for the output range. */
+        i = agst_merge_path( &w->ctx, a, mid - base, b, end - mid, lo - base );
+        j = lo - base - i;
+        ie = agst_merge_path( &w->ctx, a, mid - base, b, end - mid, hi - base );
+        je = hi - base - ie;
+
+        while ( i < ie && j < je ) {
+            if ( agst_compare( &w->ctx, b[ j ], a[ i ] ) < 0 )
+                *out++ = b[ j++ ];
+            else
+                *out++ = a[ i++ ];
+        }
+        while ( i < ie )
+            *out++ = a[ i++ ];
+        while ( j < je )
+            *out++ = b[ j++ ];
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Run workers in threads. Caller works as the first worker.
+ *
+ * @param work    Workers.
+ * @param threads Number of workers.
+ * @param fn      Worker function.
+ */
+static void agst_run( agst_work_s* work, int threads, void* ( *fn )( void* ) )
+{
+    for ( int t = 1; t < threads; t++ )
+        work[ t ].started = pthread_create( &work[ t ].tid, NULL, fn, &work[ t ] ) == 0;
+
+    fn( &work[ 0 ] );
+
+    for ( int t = 1; t < threads; t++ ) {
+        if ( work[ t ].started )
+            pthread_join( work[ t ].tid, NULL );
+        else
+            fn( &work[ t ] );
+    }
+}
+
+
+/**
+ * Find merge path split: the number of items taken from "a" when "d"
+ * items of "a" and "b" have been merged (ties from "a" first).
+ *
+ * @param ctx Sort context.
+ * @param a   First run.
+ * @param la  First run length.
+ * @param b   Second run.
+ * @param lb  Second run length.
+ * @param d   Merged item count.
+ *
+ * @return Item count from "a".
+ */
+static po_size_t agst_merge_path(
+    agst_ctx_t ctx, po_d* a, po_size_t la, po_d* b, po_size_t lb, po_size_t d )
+{
+    po_size_t lo;
+    po_size_t hi;
+    po_size_t mid;
+
+    lo = d > lb ? d - lb : 0;
+    hi = d < la ? d : la;
+
+    while ( lo < hi ) {
+        mid = lo + ( hi - lo ) / 2;
+        if ( agst_compare( ctx, a[ mid ], b[ d - mid - 1 ] ) <= 0 )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
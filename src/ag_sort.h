@@ -0,0 +1,123 @@
+#ifndef AG_SORT_H
+#define AG_SORT_H
+
+/**
+ * @file   ag_sort.h
+ *
+ * @brief  Sorting algorithms over containers.
+ *
+ *
+ * Sort provides introspective sort (introsort) for Postor data. The
+ * interface is the same as in aghp_sort_postor(), i.e. compare
+ * function with polarity, where polarity of "1" means ascending
+ * order and "-1" decending order.
+ *
+ * Introsort is quicksort with:
+ *
+ * - Median-of-3 pivot (ninther for large partitions).
+ *
+ * - Insertion sort for small partitions (AGST_INSERT_LIMIT).
+ *
+ * - Heapsort (ag_heap) fallback, if partitioning depth exceeds
+ *   2*log2(n). This guarantees O(n log n) worst case.
+ *
+ * - Fast path for presorted and reversed input, which are detected
+ *   with a single (early exiting) pass.
+ *
+ * The sort is not stable.
+ *
+ * agst_sort_parallel() is multi-threaded sort for large data. Data is
+ * split to one part per thread, the parts are introsorted in
+ * parallel, and the sorted runs are merged pairwise in rounds. In
+ * each merge round all threads are used, since the output of each
+ * round is split evenly between threads with "merge path" search,
+ * i.e. a binary search of the split point of the two runs for a
+ * given output position.
+ *
+ * agst_radix() is LSD radix sort for items with an unsigned 64-bit
+ * key, e.g. integer ids and timestamps. Key is extracted once per
+ * item with a key function, and the items are sorted by key bytes
+ * (8 passes at most) without compares. Byte histograms of all passes
+ * are collected in one pre-pass, and passes where all items have the
+ * same byte are skipped. The sort is stable.
+ *
+ */
+
+
+#include <stdint.h>
+#include <postor.h>
+
+
+/**
+ * Item key function for radix sort.
+ *
+ * @param item Item.
+ *
+ * @return Key of item.
+ */
+typedef uint64_t ( *agst_key_fn_p )( const po_d item );
+
+
+/** Partition size limit for insertion sort. */
+#define AGST_INSERT_LIMIT 24
+
+/** Default item count limit for parallel sort. */
+#define AGST_PARALLEL_CUTOFF ( 64 * 1024 )
+
+
+/**
+ * Sort Postor data with introsort.
+ *
+ * @param po  Postor.
+ * @param cmp Data compare function.
+ * @param dir Sort polarity (1 = ascending, -1 = decending).
+ */
+void agst_sort( po_t po, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Sort data array with introsort.
+ *
+ * @param data Data array.
+ * @param cnt  Data count.
+ * @param cmp  Data compare function.
+ * @param dir  Sort polarity (1 = ascending, -1 = decending).
+ */
+void agst_sort_array( po_d* data, po_size_t cnt, po_compare_fn_p cmp, po_pos_t dir );
+
+
+/**
+ * Sort Postor data with multiple threads.
+ *
+ * If thread count is below 2, or item count is below "cutoff",
+ * agst_sort() is used instead. Merging requires a scratch buffer of
+ * item count size. If buffer or thread creation fails, the sort
+ * completes with less parallelism.
+ *
+ * @param po      Postor.
+ * @param cmp     Data compare function.
+ * @param dir     Sort polarity (1 = ascending, -1 = decending).
+ * @param threads Number of threads.
+ * @param cutoff  Minimum item count for parallel sort (e.g. AGST_PARALLEL_CUTOFF).
+ */
+void agst_sort_parallel(
+    po_t po, po_compare_fn_p cmp, po_pos_t dir, int threads, po_size_t cutoff );
+
+
+/**
+ * Sort Postor data with radix sort.
+ *
+ * Scratch memory of 4 words per item is needed.
+ *
+ * @param po  Postor.
+ * @param key Item key function.
+ * @param dir Sort polarity (1 = ascending, -1 = decending).
+ *
+ * @return 0 on success, -1 if scratch allocation failed (data is
+ * unchanged).
+ */
+int agst_radix( po_t po, agst_key_fn_p key, po_pos_t dir );
+
+
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef AG_THEAP_H
+#define AG_THEAP_H
+
+/**
+ * @file   ag_theap.h
+ *
+ * @brief  Typed inline-key heap generated with macros.
+ *
+ *
+ * Typed Heap is a type specialized variant of Heap (see
+ * ag_heap.h). Keys and values are stored inline in two contiguous
+ * arrays, and the compare is an expression that is expanded into the
+ * sift loops. Hence there are no indirect compare calls and no
+ * pointer chasing during sifts.
+ *
+ * A heap type and its functions are generated with:
+ *
+ *     AGHP_DEFINE( name, key_type, value_type, less_expr )
+ *
+ * "less_expr" is an expression over the keys "a" and "b", which is
+ * true when "a" is to be closer to root than "b". E.g. "a < b" gives
+ * min-at-root heap and "a > b" max-at-root heap. Polarity is thus
+ * fixed per type.
+ *
+ * Example:
+ *
+ *     AGHP_DEFINE( iheap, int, void*, a < b )
+ *
+ *     iheap_t h = iheap_new( 16 );
+ *     iheap_put( h, 3, ptr );
+ *     ...
+ *     while ( iheap_get( h, &key, &val ) ) ...
+ *     iheap_del( h );
+ *
+ * Generated type and functions (prefixed with "name"):
+ *
+ *     name_s, name_t    Struct and handle.
+ *     name_new()        Create heap with initial size.
+ *     name_init()       Initialize heap struct with initial size.
+ *     name_del()        Delete heap.
+ *     name_deinit()     Release heap struct storage.
+ *     name_push()       Append item without heap ordering.
+ *     name_put()        Put item to heap.
+ *     name_get()        Get root item from heap.
+ *     name_peek()       Peek root item.
+ *     name_ify()        Heapify (after name_push()).
+ *     name_sort()       Sort items in "less_expr" order.
+ *     name_cnt()        Item count.
+ *     name_is_empty()   Return 1 if empty.
+ *
+ * The indexing is 0-based: children of N are at 2*N+1 and 2*N+2.
+ *
+ */
+
+
+#include <string.h>
+#include <postor.h>
+
+
+/** Minimum storage size (items) for Typed Heap. */
+#define AGHP_TYPED_MIN_SIZE 4
+
+
+/**
+ * Define Typed Heap type and its functions.
+ *
+ * @param name       Type and function prefix.
+ * @param key_type   Key (priority) type.
+ * @param value_type Value type.
+ * @param less_expr  Expression over keys "a" and "b".
+ */
+#define AGHP_DEFINE( name, key_type, value_type, less_expr )                   \
+                                                                               \
+    typedef struct name##_s                                                    \
+    {                                                                          \
+        key_type*   key;  /**< Keys. */                                        \
+        value_type* val;  /**< Values. */                                      \
+        po_size_t   cnt;  /**< Item count. */                                  \
+        po_size_t   size; /**< Storage size (items). */                        \
+    } name##_s;                                                                \
+                                                                               \
+    typedef name##_s* name##_t;                                                \
+                                                                               \
+    static inline int name##_less( key_type a, key_type b )                    \
+    {                                                                          \
+        return ( less_expr );                                                  \
+    }                                                                          \
+                                                                               \
+    static inline void name##_init( name##_t h, po_size_t size )               \
+    {                                                                          \
+        if ( size < AGHP_TYPED_MIN_SIZE )                                      \
+            size = AGHP_TYPED_MIN_SIZE;                                        \
+        h->key = po_malloc( size * sizeof( key_type ) );                       \
+        h->val = po_malloc( size * sizeof( value_type ) );                     \
+        h->cnt = 0;                                                            \
+        h->size = size;                                                        \
+    }                                                                          \
+                                                                               \
+    static inline name##_t name##_new( po_size_t size )                        \
+    {                                                                          \
+        name##_t h;                                                            \
+        h = po_malloc( sizeof( name##_s ) );                                   \
+        name##_init( h, size );                                                \
+        return h;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void name##_deinit( name##_t h )                             \
+    {                                                                          \
+        po_free( h->key );                                                     \
+        po_free( h->val );                                                     \
+        h->key = NULL;                                                         \
+        h->val = NULL;                                                         \
+        h->cnt = 0;                                                            \
+        h->size = 0;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline name##_t name##_del( name##_t h )                            \
+    {                                                                          \
+        name##_deinit( h );                                                    \
+        po_free( h );                                                          \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline void name##_resize( name##_t h, po_size_t size )             \
+    {                                                                          \
+        key_type*   key;                                                       \
+        value_type* val;                                                       \
+        key = po_malloc( size * sizeof( key_type ) );                          \
+        val = po_malloc( size * sizeof( value_type ) );                        \
+        memcpy( key, h->key, h->cnt * sizeof( key_type ) );                   \
+        memcpy( val, h->val, h->cnt * sizeof( value_type ) );                  \
+        po_free( h->key );                                                     \
+        po_free( h->val );                                                     \
+        h->key = key;                                                          \
+        h->val = val;                                                          \
+        h->size = size;                                                        \
+    }                                                                          \
+                                                                               \
+    static inline void name##_sift_up(                                         \
+        name##_t h, po_size_t i, key_type key, value_type val )                \
+    {                                                                          \
+        po_size_t parent;                                                      \
+        while ( i > 0 ) {                                                      \
+            parent = ( i - 1 ) >> 1;                                           \
+            if ( !name##_less( key, h->key[ parent ] ) )                       \
+                break;                                                         \
+            h->key[ i ] = h->key[ parent ];                                    \
+            h->val[ i ] = h->val[ parent ];                                    \
+            i = parent;                                                        \
+        }                                                                      \
+        h->key[ i ] = key;                                                     \
+        h->val[ i ] = val;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline void name##_sift_down(                                       \
+        name##_t h, po_size_t i, key_type key, value_type val )                \
+    {                                                                          \
+        po_size_t child;                                                       \
+        while ( ( child = 2 * i + 1 ) < h->cnt ) {                             \
+            if ( child + 1 < h->cnt                                            \
+                 && name##_less( h->key[ child + 1 ], h->key[ child ] ) )      \
+                child++;                                                       \
+            if ( !name##_less( h->key[ child ], key ) )                        \
+                break;                                                         \
+            h->key[ i ] = h->key[ child ];                                     \
+            h->val[ i ] = h->val[ child ];                                     \
+            i = child;                                                         \
+        }                                                                      \
+        h->key[ i ] = key;                                                     \
+        h->val[ i ] = val;                                                     \
+    }                                                                          \
+                                                                               \
+    static inline void name##_push( name##_t h, key_type key, value_type val ) \
+    {                                                                          \
+        if ( h->cnt >= h->size )                                               \
+            name##_resize( h, 2 * h->size );                                   \
+        h->key[ h->cnt ] = key;                                                \
+        h->val[ h->cnt ] = val;                                                \
+        h->cnt++;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void name##_put( name##_t h, key_type key, value_type val )  \
+    {                                                                          \
+        if ( h->cnt >= h->size )                                               \
+            name##_resize( h, 2 * h->size );                                   \
+        name##_sift_up( h, h->cnt++, key, val );                               \
+    }                                                                          \
+                                                                               \
+    static inline int name##_peek(                                             \
+        name##_t h, key_type* key, value_type* val )                           \
+    {                                                                          \
+        if ( h->cnt == 0 )                                                     \
+            return 0;                                                          \
+        if ( key )                                                             \
+            *key = h->key[ 0 ];                                                \
+        if ( val )                                                             \
+            *val = h->val[ 0 ];                                                \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline int name##_get(                                              \
+        name##_t h, key_type* key, value_type* val )                           \
+    {                                                                          \
+        if ( h->cnt == 0 )                                                     \
+            return 0;                                                          \
+        if ( key )                                                             \
+            *key = h->key[ 0 ];                                                \
+        if ( val )                                                             \
+            *val = h->val[ 0 ];                                                \
+        h->cnt--;                                                              \
+        if ( h->cnt > 0 )                                                      \
+            name##_sift_down( h, 0, h->key[ h->cnt ], h->val[ h->cnt ] );      \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void name##_ify( name##_t h )                                \
+    {                                                                          \
+        for ( po_size_t i = h->cnt / 2; i-- > 0; )                             \
+            name##_sift_down( h, i, h->key[ i ], h->val[ i ] );                \
+    }                                                                          \
+                                                                               \
+    static inline void name##_sort( name##_t h )                               \
+    {                                                                          \
+        po_size_t  lim;                                                        \
+        key_type   key;                                                        \
+        value_type val;                                                        \
+        lim = h->cnt;                                                          \
+        name##_ify( h );                                                       \
+        /* Roots are collected to tail, i.e. in reverse order. */              \
+        while ( h->cnt > 1 ) {                                                 \
+            key = h->key[ 0 ];                                                 \
+            val = h->val[ 0 ];                                                 \
+            name##_get( h, NULL, NULL );                                       \
+            h->key[ h->cnt ] = key;                                            \
+            h->val[ h->cnt ] = val;                                            \
+        }                                                                      \
+        h->cnt = lim;                                                          \
+        for ( po_size_t i = 0, j = lim; i + 1 < j; i++ ) {                     \
+            j--;                                                               \
+            key = h->key[ i ];                                                 \
+            h->key[ i ] = h->key[ j ];                                         \
+            h->key[ j ] = key;                                                 \
+            val = h->val[ i ];                                                 \
+            h->val[ i ] = h->val[ j ];                                         \
+            h->val[ j ] = val;                                                 \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline po_size_t name##_cnt( name##_t h )                           \
+    {                                                                          \
+        return h->cnt;                                                         \
+    }                                                                          \
+                                                                               \
+    static inline int name##_is_empty( name##_t h )                            \
+    {                                                                          \
+        return h->cnt == 0;                                                    \
+    }
+
+
+#endif
@@ -0,0 +1,292 @@
+/**
+ * @file   ag_timer.c
+ *
+ * @brief  Hierarchical timing wheel.
+ */
+
+#include "ag_timer.h"
+
+
+/** Return slot list head of level and index. */
+#define agtm_slot( w, level, idx ) ( &( w )->slot[ ( level )*AGTM_SLOTS + ( idx ) ] )
+
+/** Ticks covered by one slot of level. */
+#define agtm_span( level ) ( (uint64_t)1 << ( AGTM_SLOT_BITS * ( level ) ) )
+
+
+static void agtm_link( agtm_t w, agtm_entry_t e );
+static void agtm_unlink( agtm_t w, agtm_entry_t e );
+static void agtm_cascade( agtm_t w, po_size_t level, uint64_t t );
+
+
+
+agtm_t agtm_new( uint64_t tick, po_size_t levels, uint64_t now )
+{
+    agtm_t w;
+    w = po_malloc( sizeof( agtm_s ) );
+    agtm_init( w, tick, levels, now );
+    return w;
+}
+
+
+void agtm_init( agtm_t w, uint64_t tick, po_size_t levels, uint64_t now )
+{
+    agtm_entry_t head;
+
+    if ( levels < 1 )
+        levels = 1;
+    else if ( levels > AGTM_MAX_LEVELS )
+        levels = AGTM_MAX_LEVELS;
+
+    if ( tick < 1 )
+        tick = 1;
+
+    w->slot = po_malloc( levels * AGTM_SLOTS * sizeof( agtm_entry_s ) );
+    w->lcnt = po_malloc( levels * sizeof( po_size_t ) );
+    w->levels = levels;
+    w->tick = tick;
+    w->cur = now / tick;
+    w->cnt = 0;
+
+    for ( po_size_t i = 0; i < levels * AGTM_SLOTS; i++ ) {
+        head = &w->slot[ i ];
+        head->next = head;
+        head->prev = head;
+    }
+
+    for ( po_size_t i = 0; i < levels; i++ )
+        w->lcnt[ i ] = 0;
+}
+
+
+void agtm_deinit( agtm_t w )
+{
+    po_free( w->slot );
+    po_free( w->lcnt );
+    w->slot = NULL;
+    w->lcnt = NULL;
+    w->cnt = 0;
+}
+
+
+agtm_t agtm_del( agtm_t w )
+{
+    agtm_deinit( w );
+    po_free( w );
+    return NULL;
+}
+
+
+void agtm_entry_init( agtm_entry_t e, po_d data )
+{
+    e->next = NULL;
+    e->prev = NULL;
+    e->expire = 0;
+    e->tick = 0;
+    e->level = 0;
+    e->data = data;
+}
+
+
+void agtm_schedule( agtm_t w, agtm_entry_t e, uint64_t expire )
+{
+    if ( agtm_is_scheduled( e ) )
+        agtm_unlink( w, e );
+
+    e->expire = expire;
+    e->tick = expire / w->tick + ( expire % w->tick != 0 );
+
+    agtm_link( w, e );
+}
+
+
+int agtm_cancel( agtm_t w, agtm_entry_t e )
+{
+    if ( agtm_is_scheduled( e ) ) {
+        agtm_unlink( w, e );
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+
+int agtm_is_scheduled( agtm_entry_t e )
+{
+    if ( e->next )
+        return 1;
+    else
+        return 0;
+}
+
+
+po_size_t agtm_advance( agtm_t w, uint64_t now, agtm_expire_fn_p cb, void* arg )
+{
+    uint64_t     target;
+    uint64_t     t;
+    uint64_t     next;
+    po_size_t    level;
+    po_size_t    top;
+    po_size_t    ret;
+    agtm_entry_s batch;
+    agtm_entry_t head;
+    agtm_entry_t e;
+
+    target = now / w->tick;
+    ret = 0;
+
+    while ( w->cur < target ) {
+
+        if ( w->cnt == 0 ) {
+            w->cur = target;
+            break;
+        }
+
+        /*
+         * Nothing can happen before the next slot boundary of the
+         * lowest non-empty level, hence skip the ticks in between.
+         */
+        for ( level = 0; w->lcnt[ level ] == 0; level++ )
+            ;
+        if ( level > 0 ) {
+            next = ( ( w->cur >> ( AGTM_SLOT_BITS * level ) ) + 1 )
+                   << ( AGTM_SLOT_BITS * level );
+            if ( next - 1 > w->cur )
+                w->cur = next - 1 < target ? next - 1 : target;
+            if ( w->cur >= target )
+                break;
+        }
+
+        t = w->cur + 1;
+
+        /* Cascade from the highest wrapped level down. */
+        top = 0;
+        while ( top + 1 < w->levels && ( t & ( agtm_span( top + 1 ) - 1 ) ) == 0 )
+            top++;
+        for ( level = top; level > 0; level-- )
+            agtm_cascade( w, level, t );
+
+        /* Detach the due slot as a batch, so callbacks may re-schedule. */
+        head = agtm_slot( w, 0, t & ( AGTM_SLOTS - 1 ) );
+        w->cur = t;
+
+        if ( head->next == head )
+            continue;
+
+        batch.next = head->next;
+        batch.prev = head->prev;
+        batch.next->prev = &batch;
+        batch.prev->next = &batch;
+        head->next = head;
+        head->prev = head;
+
+        while ( batch.next != &batch ) {
+            e = batch.next;
+            agtm_unlink( w, e );
+            if ( e->tick > t ) {
+                /* Parked beyond wheel range. */
+                agtm_link( w, e );
+            } else {
+                cb( e, arg );
+                ret++;
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+po_size_t agtm_cnt( agtm_t w )
+{
+    return w->cnt;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Link entry to the slot of its expiry tick.
+ *
+ * @param w Timer.
+ * @param e Entry.
+ */
+static void agtm_link( agtm_t w, agtm_entry_t e )
+{
+    uint64_t     base;
+    uint64_t     tick;
+    uint64_t     delta;
+    po_size_t    level;
+    agtm_entry_t head;
+
+    /* Next tick to be processed. */
+    base = w->cur + 1;
+    tick = e->tick < base ? base : e->tick;
+    delta = tick - base;
+
+    level = 0;
+    while ( level + 1 < w->levels && delta >= agtm_span( level + 1 ) )
+        level++;
+
+    /* Beyond wheel range: park to the farthest top level slot. */
+    if ( delta >= agtm_span( level + 1 ) && level + 1 == w->levels )
+        tick = base + agtm_span( w->levels ) - 1;
+
+    head = agtm_slot(
+        w, level, ( tick >> ( AGTM_SLOT_BITS * level ) ) & ( AGTM_SLOTS - 1 ) );
+
+    e->level = level;
+    e->next = head;
+    e->prev = head->prev;
+    head->prev->next = e;
+    head->prev = e;
+
+    w->lcnt[ level ]++;
+    w->cnt++;
+}
+
+
+/**
+ * Unlink entry from its slot.
+ *
+ * @param w Timer.
+ * @param e Entry.
+ */
+static void agtm_unlink( agtm_t w, agtm_entry_t e )
+{
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+    e->next = NULL;
+    e->prev = NULL;
+
+    w->lcnt[ e->level ]--;
+    w->cnt--;
+}
+
+
+/**
+ * Re-insert entries of the level slot for tick t.
+ *
+ * @param w     Timer.
+ * @param level Level.
+ * @param t     Tick to be processed.
+ */
+static void agtm_cascade( agtm_t w, po_size_t level, uint64_t t )
+{
+    agtm_entry_t head;
+    agtm_entry_t e;
+
+    head = agtm_slot( w, level, ( t >> ( AGTM_SLOT_BITS * level ) ) & ( AGTM_SLOTS - 1 ) );
+
+    /* Cur is set so that t is the next tick to be processed. */
+    w->cur = t - 1;
+
+    while ( head->next != head ) {
+        e = head->next;
+        agtm_unlink( w, e );
+        agtm_link( w, e );
+    }
+}
@@ -0,0 +1,235 @@
+#ifndef AG_TIMER_H
+#define AG_TIMER_H
+
+/**
+ * @file   ag_timer.h
+ *
+ * @brief  Hierarchical timing wheel.
+ *
+ *
+ * Timer is a hierarchical timing wheel for large numbers of timeouts,
+ * where most timers are typically cancelled before they expire
+ * (e.g. idle connection timeouts). Schedule and cancel are O(1), and
+ * expiry is done in batches with agtm_advance().
+ *
+ * Time is given in user units (e.g. ms), and the wheel resolution is
+ * "tick" units. Expiry time is rounded up to the next tick, hence a
+ * timer never expires before its time.
+ *
+ * The wheel has "levels" levels of AGTM_SLOTS slots each. Level 0
+ * slot covers one tick, level 1 slot covers AGTM_SLOTS ticks, and so
+ * on. A timer is placed to the lowest level which can hold its
+ * expiry time. When the lower level wraps around, the entries of the
+ * next level slot are cascaded (re-inserted) to the lower
+ * levels. Timers beyond the range of the wheel are parked in the top
+ * level and re-inserted when visited.
+ *
+ *
+ *     Level 2: | 0 | 1 | 2 | ... | 63 |     (each slot 4096 ticks)
+ *                    |
+ *                    +--> cascade
+ *     Level 1: | 0 | 1 | 2 | ... | 63 |     (each slot 64 ticks)
+ *                    |
+ *                    +--> cascade
+ *     Level 0: | 0 | 1 | 2 | ... | 63 |     (each slot 1 tick)
+ *
+ *
+ * Timer entries are intrusive, i.e. the user owns the entry storage
+ * (typically embedded in the user object) and the wheel links entries
+ * to slot lists. Slot lists are doubly-linked, hence cancel is a
+ * plain unlink. The "data" field is free for user.
+ *
+ */
+
+
+#include <stdint.h>
+#include <postor.h>
+
+
+/** Slot bits per level. */
+#define AGTM_SLOT_BITS 6
+
+/** Slots per level. */
+#define AGTM_SLOTS ( 1 << AGTM_SLOT_BITS )
+
+/** Maximum number of levels. */
+#define AGTM_MAX_LEVELS ( 64 / AGTM_SLOT_BITS )
+
+
+/**
+ * Timer entry struct.
+ */
+struct agtm_entry_s
+{
+    struct agtm_entry_s* next;   /**< Next in slot. */
+    struct agtm_entry_s* prev;   /**< Previous in slot. */
+    uint64_t             expire; /**< Expiry time (user units). */
+    uint64_t             tick;   /**< Expiry tick. */
+    po_size_t            level;  /**< Wheel level. */
+    po_d                 data;   /**< User data. */
+};
+
+/** Short type for Timer entry struct. */
+typedef struct agtm_entry_s agtm_entry_s;
+
+/** Handle type for Timer entry. */
+typedef struct agtm_entry_s* agtm_entry_t;
+
+
+/**
+ * Timer expiry callback.
+ *
+ * Entry is unlinked before callback, hence it can be re-scheduled
+ * (or freed) within the callback.
+ *
+ * @param e   Expired entry.
+ * @param arg User argument.
+ */
+typedef void ( *agtm_expire_fn_p )( agtm_entry_t e, void* arg );
+
+
+/**
+ * Timer struct.
+ */
+struct agtm_s
+{
+    agtm_entry_s* slot;   /**< Slot list heads (levels * AGTM_SLOTS). */
+    po_size_t*    lcnt;   /**< Entry count per level. */
+    po_size_t     levels; /**< Number of levels. */
+    uint64_t      tick;   /**< Tick length (user units). */
+    uint64_t      cur;    /**< Last processed tick. */
+    po_size_t     cnt;    /**< Scheduled entry count. */
+};
+
+/** Short type for Timer struct. */
+typedef struct agtm_s agtm_s;
+
+/** Handle type for Timer. */
+typedef struct agtm_s* agtm_t;
+
+
+
+/**
+ * Create Timer.
+ *
+ * Levels is limited to 1 ... AGTM_MAX_LEVELS. Range of the wheel is
+ * AGTM_SLOTS^levels ticks.
+ *
+ * @param tick   Tick length (user units).
+ * @param levels Number of levels.
+ * @param now    Current time (user units).
+ *
+ * @return Timer.
+ */
+agtm_t agtm_new( uint64_t tick, po_size_t levels, uint64_t now );
+
+
+/**
+ * Initialize Timer.
+ *
+ * See agtm_new() for details about parameters.
+ *
+ * @param w      Timer.
+ * @param tick   Tick length (user units).
+ * @param levels Number of levels.
+ * @param now    Current time (user units).
+ */
+void agtm_init( agtm_t w, uint64_t tick, po_size_t levels, uint64_t now );
+
+
+/**
+ * Release Timer storage.
+ *
+ * Scheduled entries are abandoned (not unlinked).
+ *
+ * @param w Timer.
+ */
+void agtm_deinit( agtm_t w );
+
+
+/**
+ * Delete Timer.
+ *
+ * @param w Timer.
+ *
+ * @return NULL
+ */
+agtm_t agtm_del( agtm_t w );
+
+
+/**
+ * Initialize Timer entry.
+ *
+ * Entry must be initialized before first use.
+ *
+ * @param e    Entry.
+ * @param data User data.
+ */
+void agtm_entry_init( agtm_entry_t e, po_d data );
+
+
+/**
+ * Schedule entry to expire at given time.
+ *
+ * If entry is already scheduled, it is re-scheduled. Timer works in
+ * ticks, and the current tick has already been processed. Hence an
+ * expiry time within the current tick, or in the past, is moved to
+ * the next tick. Such entry expires at the first agtm_advance() that
+ * reaches the next tick, not at an advance within the current tick.
+ *
+ * @param w      Timer.
+ * @param e      Entry.
+ * @param expire Expiry time (user units).
+ */
+void agtm_schedule( agtm_t w, agtm_entry_t e, uint64_t expire );
+
+
+/**
+ * Cancel entry.
+ *
+ * @param w Timer.
+ * @param e Entry.
+ *
+ * @return 1 if entry was scheduled (else 0).
+ */
+int agtm_cancel( agtm_t w, agtm_entry_t e );
+
+
+/**
+ * Return 1 if entry is scheduled.
+ *
+ * @param e Entry.
+ *
+ * @return 1 if scheduled (else 0).
+ */
+int agtm_is_scheduled( agtm_entry_t e );
+
+
+/**
+ * Advance Timer to given time.
+ *
+ * All entries with expiry tick up to the tick of "now" are expired
+ * and passed to callback, in expiry tick order.
+ *
+ * @param w   Timer.
+ * @param now Current time (user units).
+ * @param cb  Expiry callback.
+ * @param arg Callback argument.
+ *
+ * @return Number of expired entries.
+ */
+po_size_t agtm_advance( agtm_t w, uint64_t now, agtm_expire_fn_p cb, void* arg );
+
+
+/**
+ * Return scheduled entry count.
+ *
+ * @param w Timer.
+ *
+ * @return Count.
+ */
+po_size_t agtm_cnt( agtm_t w );
+
+
+
+#endif
@@ -0,0 +1,494 @@
+/**
+ * @file   ag_xsort.c
+ *
+ * @brief  External merge sort for data larger than memory.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ag_xsort.h"
+#include "ag_sort.h"
+#include "ag_merge.h"
+
+
+/**
+ * Sorted run in temporary file. Pending runs hold only the file
+ * descriptor, and stdio stream and buffer are attached for writing
+ * and reading.
+ */
+typedef struct agxs_run_s
+{
+    int         fd;    /**< File descriptor. */
+    FILE*       fh;    /**< File stream (when attached). */
+    char*       buf;   /**< File buffer (when attached). */
+    po_size_t   level; /**< Merge level (0 for spilled run). */
+    agxs_conf_t conf;  /**< Configuration. */
+} agxs_run_s;
+
+/** Handle type for run. */
+typedef agxs_run_s* agxs_run_t;
+
+
+/**
+ * Run writer.
+ */
+typedef struct agxs_writer_s
+{
+    agxs_run_t run; /**< Output run. */
+    int        err; /**< Error seen. */
+} agxs_writer_s;
+
+
+static agxs_run_t agxs_run_open( agxs_conf_t conf, po_size_t level );
+static int agxs_run_attach( agxs_run_t run );
+static int agxs_run_detach( agxs_run_t run );
+static void agxs_run_close( agxs_run_t run );
+static po_d agxs_run_next( void* arg );
+static void agxs_run_emit( po_d item, void* arg );
+static void agxs_free_items( agxs_conf_t conf, po_t po );
+static int agxs_spill( agxs_conf_t conf, po_t mem, po_t runs );
+static int agxs_merge(
+    agxs_conf_t conf, po_t runs, po_size_t first, po_size_t cnt, agxs_run_t out );
+static int agxs_merge_top( agxs_conf_t conf, po_t runs, po_size_t cnt );
+
+
+
+void agxs_conf_init( agxs_conf_t conf )
+{
+    memset( conf, 0, sizeof( agxs_conf_s ) );
+    conf->dir = 1;
+    conf->fanin = AGXS_FANIN;
+    conf->bufsize = AGXS_BUFSIZE;
+}
+
+
+int agxs_sort( agxs_conf_t conf )
+{
+    po_t      mem;
+    po_t      runs;
+    po_d      item;
+    size_t    used;
+    po_size_t cnt;
+    int       ret;
+    int       err;
+
+    if ( conf->fanin < 2 )
+        conf->fanin = AGXS_FANIN;
+    if ( conf->bufsize == 0 )
+        conf->bufsize = AGXS_BUFSIZE;
+
+    mem = po_new_sized( NULL, 1024 );
+    runs = po_new_sized( NULL, 16 );
+    ret = 0;
+    used = 0;
+
+    /* Create sorted runs within memory budget. */
+    while ( ( item = conf->input( conf->arg ) ) != NULL ) {
+
+        po_push( mem, item );
+        used += sizeof( po_d ) + ( conf->size ? conf->size( item, conf->arg ) : 0 );
+
+        if ( used >= conf->memory ) {
+            if ( agxs_spill( conf, mem, runs ) ) {
+                ret = -1;
+                break;
+            }
+            used = 0;
+        }
+    }
+
+    if ( ret == 0 && runs->used == 0 ) {
+
+        /* All items fit to memory. */
+        agst_sort( mem, conf->cmp, conf->dir );
+        for ( po_size_t i = 0; i < mem->used; i++ )
+            conf->emit( mem->data[ i ], conf->arg );
+        mem->used = 0;
+
+    } else if ( ret == 0 ) {
+
+        if ( mem->used > 0 && agxs_spill( conf, mem, runs ) )
+            ret = -1;
+
+        /*
+         * Merge the smallest (latest) runs until "fanin" runs are
+         * left for the final merge.
+         */
+        while ( ret == 0 && runs->used > conf->fanin ) {
+            cnt = runs->used - conf->fanin + 1;
+            if ( cnt > conf->fanin )
+                cnt = conf->fanin;
+            if ( agxs_merge_top( conf, runs, cnt ) )
+                ret = -1;
+        }
+
+        if ( ret == 0 && agxs_merge( conf, runs, 0, runs->used, NULL ) )
+            ret = -1;
+    }
+
+    /* Cleanup. */
+    err = errno;
+    agxs_free_items( conf, mem );
+    for ( po_size_t i = 0; i < runs->used; i++ )
+        agxs_run_close( runs->data[ i ] );
+    po_del( mem );
+    po_del( runs );
+    errno = err;
+
+    return ret;
+}
+
+
+
+/* ------------------------------------------------------------
+ * Internal support:
+ */
+
+/**
+ * Open temporary file for run.
+ *
+ * @param conf  Configuration.
+ * @param level Merge level.
+ *
+ * @return Run, NULL on error.
+ */
+static agxs_run_t agxs_run_open( agxs_conf_t conf, po_size_t level )
+{
+    agxs_run_t run;
+    FILE*      fh;
+    char*      path;
+    size_t     len;
+    int        fd;
+
+    fd = -1;
+
+    if ( conf->tmpdir ) {
+
+        len = strlen( conf->tmpdir ) + sizeof( "/agxs-XXXXXX" );
+        path = po_malloc( len );
+        snprintf( path, len, "%s/agxs-XXXXXX", conf->tmpdir );
+
+        fd = mkstemp( path );
+        if ( fd >= 0 ) {
+            /* File is removed on close. */
+            unlink( path );
+        }
+
+        po_free( path );
+
+    } else {
+
+        /* Descriptor keeps the (removed) file after stream close. */
+        fh = tmpfile();
+        if ( fh ) {
+            fd = dup( fileno( fh ) );
+            fclose( fh );
+        }
+    }
+
+    if ( fd < 0 )
+        return NULL;
+
+    run = po_malloc( sizeof( agxs_run_s ) );
+    run->conf = conf;
+    run->fd = fd;
+    run->fh = NULL;
+    run->buf = NULL;
+    run->level = level;
+
+    return run;
+}
+
+
+/**
+ * Attach stream and buffer to run, at the start of file.
+ *
+ * @param run Run.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int agxs_run_attach( agxs_run_t run )
+{
+    int fd;
+
+    if ( lseek( run->fd, 0, SEEK_SET ) < 0 )
+        return -1;
+
+    fd = dup( run->fd );
+    if ( fd < 0 )
+        return -1;
+
+    run->fh = fdopen( fd, "r+b" );
+    if ( run->fh == NULL ) {
+        close( fd );
+        return -1;
+    }
+
+    run->buf = po_malloc( run->conf->bufsize );
+    setvbuf( run->fh, run->buf, _IOFBF, run->conf->bufsize );
+
+#if defined( POSIX_FADV_SEQUENTIAL )
+    /* Run is written or read once from start to end: aggressive read-ahead. */
+    posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+
+    return 0;
+}
+
+
+/**
+ * Detach (flush and close) run stream and release buffer.
+ *
+ * @param run Run.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int agxs_run_detach( agxs_run_t run )
+{
+    int ret;
+
+    if ( run->fh == NULL )
+        return 0;
+
+    ret = ferror( run->fh ) ? -1 : 0;
+    if ( fclose( run->fh ) != 0 )
+        ret = -1;
+    po_free( run->buf );
+    run->fh = NULL;
+    run->buf = NULL;
+
+    return ret;
+}
+
+
+/**
+ * Close and remove run.
+ *
+ * @param run Run (or NULL).
+ */
+static void agxs_run_close( agxs_run_t run )
+{
+    if ( run == NULL )
+        return;
+
+    agxs_run_detach( run );
+    close( run->fd );
+    po_free( run );
+}
+
+
+/**
+ * Merge source function for run.
+ *
+ * @param arg Run.
+ *
+ * @return Next item, NULL at end.
+ */
+static po_d agxs_run_next( void* arg )
+{
+    agxs_run_t run = (agxs_run_t)arg;
+
+    return run->conf->read( run->fh, run->conf->arg );
+}
+
+
+/**
+ * Merge output function for run.
+ *
+ * @param item Item.
+ * @param arg  Writer.
+ */
+static void agxs_run_emit( po_d item, void* arg )
+{
+    agxs_writer_s* w = (agxs_writer_s*)arg;
+    agxs_conf_t    conf = w->run->conf;
+
+    if ( !w->err && conf->write( w->run->fh, item, conf->arg ) )
+        w->err = 1;
+
+    conf->free( item, conf->arg );
+}
+
+
+/**
+ * Free items in Postor.
+ *
+ * @param conf Configuration.
+ * @param po   Postor.
+ */
+static void agxs_free_items( agxs_conf_t conf, po_t po )
+{
+    for ( po_size_t i = 0; i < po->used; i++ )
+        conf->free( po->data[ i ], conf->arg );
+    po->used = 0;
+}
+
+
+/**
+ * Sort items in memory and write them to a new run. Runs are merged,
+ * when "fanin" runs of the same level are pending.
+ *
+ * @param conf Configuration.
+ * @param mem  Items.
+ * @param runs Runs.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int agxs_spill( agxs_conf_t conf, po_t mem, po_t runs )
+{
+    agxs_run_t run;
+    agxs_run_t top;
+    po_size_t  n;
+
+    run = agxs_run_open( conf, 0 );
+    if ( run == NULL )
+        return -1;
+    po_push( runs, run );
+
+    if ( agxs_run_attach( run ) )
+        return -1;
+
+    agst_sort( mem, conf->cmp, conf->dir );
+
+    for ( po_size_t i = 0; i < mem->used; i++ ) {
+        if ( conf->write( run->fh, mem->data[ i ], conf->arg ) )
+            return -1;
+    }
+
+    agxs_free_items( conf, mem );
+
+    if ( agxs_run_detach( run ) )
+        return -1;
+
+    /*
+     * Run levels are non-increasing towards the latest run. Merge the
+     * latest runs while "fanin" of them have the same level, hence at
+     * most "fanin"-1 runs per level are pending.
+     */
+    while ( runs->used >= conf->fanin ) {
+        top = runs->data[ runs->used - 1 ];
+        for ( n = 1; n < conf->fanin; n++ ) {
+            run = runs->data[ runs->used - 1 - n ];
+            if ( run->level != top->level )
+                break;
+        }
+        if ( n < conf->fanin )
+            break;
+        if ( agxs_merge_top( conf, runs, conf->fanin ) )
+            return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Merge runs to output run, or to user emit if "out" is NULL.
+ *
+ * @param conf  Configuration.
+ * @param runs  Runs.
+ * @param first First run to merge.
+ * @param cnt   Number of runs to merge.
+ * @param out   Output run (or NULL).
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int agxs_merge(
+    agxs_conf_t conf, po_t runs, po_size_t first, po_size_t cnt, agxs_run_t out )
+{
+    agmg_source_s* src;
+    agmg_s         ms;
+    agxs_writer_s  w;
+    agxs_run_t     run;
+    int            ret;
+
+    /* Streams are attached only for the merge. */
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        if ( agxs_run_attach( runs->data[ first + i ] ) )
+            return -1;
+    }
+
+    src = po_malloc( ( cnt + 1 ) * sizeof( agmg_source_s ) );
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        src[ i ].next = agxs_run_next;
+        src[ i ].arg = runs->data[ first + i ];
+    }
+
+    agmg_init( &ms, src, cnt, conf->cmp, conf->dir );
+
+    if ( out ) {
+        w.run = out;
+        w.err = 0;
+        agmg_drain( &ms, agxs_run_emit, &w );
+        ret = w.err ? -1 : 0;
+    } else {
+        agmg_drain( &ms, conf->emit, conf->arg );
+        ret = 0;
+    }
+
+    agmg_deinit( &ms );
+    po_free( src );
+
+    /* Read errors end the run early. */
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        run = runs->data[ first + i ];
+        if ( agxs_run_detach( run ) ) {
+            if ( errno == 0 )
+                errno = EIO;
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+
+/**
+ * Merge the latest "cnt" runs to a new run, which replaces them.
+ *
+ * @param conf Configuration.
+ * @param runs Runs.
+ * @param cnt  Number of runs to merge.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int agxs_merge_top( agxs_conf_t conf, po_t runs, po_size_t cnt )
+{
+    agxs_run_t out;
+    agxs_run_t run;
+    po_size_t  first;
+    po_size_t  level;
+    int        ret;
+
+    first = runs->used - cnt;
+
+    /* Result is one level above the highest merged run. */
+    level = 0;
+    for ( po_size_t i = first; i < runs->used; i++ ) {
+        run = runs->data[ i ];
+        if ( run->level > level )
+            level = run->level;
+    }
+
+    out = agxs_run_open( conf, level + 1 );
+    if ( out == NULL )
+        return -1;
+
+    ret = 0;
+    if ( agxs_run_attach( out ) )
+        ret = -1;
+    if ( ret == 0 && agxs_merge( conf, runs, first, cnt, out ) )
+        ret = -1;
+    if ( agxs_run_detach( out ) )
+        ret = -1;
+
+    for ( po_size_t i = first; i < runs->used; i++ )
+        agxs_run_close( runs->data[ i ] );
+    runs->used = first;
+    po_push( runs, out );
+
+    return ret;
+}
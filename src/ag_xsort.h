@@ -0,0 +1,168 @@
+#ifndef AG_XSORT_H
+#define AG_XSORT_H
+
+/**
+ * @file   ag_xsort.h
+ *
+ * @brief  External merge sort for data larger than memory.
+ *
+ *
+ * External Sort sorts a stream of items which doesn't fit in memory:
+ *
+ * - Items are read from user input function and collected to memory
+ *   until the memory budget is reached. Collected items are sorted
+ *   (see ag_sort.h) and written to a temporary file as a sorted run,
+ *   using user serializer. Written items are freed.
+ *
+ * - While input is read, "fanin" runs of the same level are merged
+ *   (see ag_merge.h) to a new run of the next level. After input,
+ *   the latest runs are merged until at most "fanin" runs are left.
+ *   The final merge outputs the items in order to user emit
+ *   function. Each item is written about log_fanin(runs) times.
+ *
+ * If all items fit to the memory budget, no files are used.
+ *
+ * Temporary files are created to "tmpdir" (and unlinked
+ * immediately), or with tmpfile() if "tmpdir" is NULL. Files are
+ * accessed through stdio with "bufsize" buffers, and sequential
+ * read-ahead is requested from the kernel.
+ *
+ * Memory and files outside the memory budget: a pending run holds
+ * only an open file descriptor, and there are at most "fanin"-1
+ * pending runs per level, i.e. about (fanin-1) * log_fanin(runs)
+ * descriptors. Buffers are allocated only for the runs being
+ * written or merged, i.e. at most (fanin+1) * bufsize bytes.
+ *
+ * Item ownership: items from input are owned by the sort, until they
+ * are freed with the free function or passed to emit function. Emit
+ * takes ownership.
+ *
+ */
+
+
+#include <stdio.h>
+#include <postor.h>
+
+
+/** Default merge fan-in. */
+#define AGXS_FANIN 64
+
+/** Default file buffer size. */
+#define AGXS_BUFSIZE ( 256 * 1024 )
+
+
+/**
+ * Input function.
+ *
+ * @param arg User argument.
+ *
+ * @return Next item, NULL at end of input.
+ */
+typedef po_d ( *agxs_input_fn_p )( void* arg );
+
+
+/**
+ * Serializer function.
+ *
+ * @param fh   File.
+ * @param item Item.
+ * @param arg  User argument.
+ *
+ * @return 0 on success, -1 on error.
+ */
+typedef int ( *agxs_write_fn_p )( FILE* fh, const po_d item, void* arg );
+
+
+/**
+ * Deserializer function.
+ *
+ * @param fh  File.
+ * @param arg User argument.
+ *
+ * @return Item, NULL at end of file (or error, see ferror()).
+ */
+typedef po_d ( *agxs_read_fn_p )( FILE* fh, void* arg );
+
+
+/**
+ * Item free function.
+ *
+ * @param item Item.
+ * @param arg  User argument.
+ */
+typedef void ( *agxs_free_fn_p )( po_d item, void* arg );
+
+
+/**
+ * Item memory size function.
+ *
+ * @param item Item.
+ * @param arg  User argument.
+ *
+ * @return Memory used by item (in bytes).
+ */
+typedef size_t ( *agxs_size_fn_p )( const po_d item, void* arg );
+
+
+/**
+ * Output function.
+ *
+ * @param item Item.
+ * @param arg  User argument.
+ */
+typedef void ( *agxs_emit_fn_p )( po_d item, void* arg );
+
+
+/**
+ * External Sort configuration.
+ */
+struct agxs_conf_s
+{
+    po_compare_fn_p cmp;     /**< Compare function. */
+    po_pos_t        dir;     /**< Sort polarity (1 = ascending). */
+    agxs_input_fn_p input;   /**< Input function. */
+    agxs_write_fn_p write;   /**< Serializer. */
+    agxs_read_fn_p  read;    /**< Deserializer. */
+    agxs_free_fn_p  free;    /**< Item free function. */
+    agxs_size_fn_p  size;    /**< Item size function (NULL: pointer size only). */
+    agxs_emit_fn_p  emit;    /**< Output function. */
+    void*           arg;     /**< User argument for functions. */
+    size_t          memory;  /**< Memory budget for items (in bytes). */
+    po_size_t       fanin;   /**< Merge fan-in (0: AGXS_FANIN). */
+    size_t          bufsize; /**< File buffer size (0: AGXS_BUFSIZE). */
+    const char*     tmpdir;  /**< Directory for temporary files (or NULL). */
+};
+
+/** Short type for External Sort configuration. */
+typedef struct agxs_conf_s agxs_conf_s;
+
+/** Handle type for External Sort configuration. */
+typedef struct agxs_conf_s* agxs_conf_t;
+
+
+
+/**
+ * Initialize configuration with defaults.
+ *
+ * Functions, memory budget and tmpdir must be set by user.
+ *
+ * @param conf Configuration.
+ */
+void agxs_conf_init( agxs_conf_t conf );
+
+
+/**
+ * Sort items from input to output.
+ *
+ * On failure, remaining items are freed and temporary files are
+ * removed.
+ *
+ * @param conf Configuration.
+ *
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int agxs_sort( agxs_conf_t conf );
+
+
+
+#endif
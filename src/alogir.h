@@ -13,7 +13,23 @@
 
 typedef uint64_t ag_hash_t;
 
+/** 128-bit hash value. */
+typedef struct ag_hash128_s
+{
+    uint64_t lo; /**< Low 64 bits. */
+    uint64_t hi; /**< High 64 bits. */
+} ag_hash128_t;
+
 #include "ag_hash.h"
 #include "ag_heap.h"
+#include "ag_dheap.h"
+#include "ag_theap.h"
+#include "ag_iheap.h"
+#include "ag_rheap.h"
+#include "ag_timer.h"
+#include "ag_sort.h"
+#include "ag_merge.h"
+#include "ag_xsort.h"
+#include "ag_mqueue.h"
 
 #endif
@@ -1,5 +1,7 @@
 #include "unity.h"
 
+#include <string.h>
+
 #include <postor.h>
 #include "ag_heap.h"
 
@@ -135,3 +137,237 @@ void test_limits( void )
     aghp_get( h );
     TEST_ASSERT_TRUE( aghp_is_empty( h ) );
 }
+
+
+void test_ify( void )
+{
+    po_t po;
+    int  lim;
+    int  items[ 1000 ];
+    int  prev;
+    int  cur;
+
+    srand( 1234 );
+
+    lim = 1000;
+    po = po_new_sized( NULL, lim );
+
+    for ( int i = 0; i < lim; i++ ) {
+        items[ i ] = rand_within( 500 );
+        po_push( po, &items[ i ] );
+    }
+
+    aghp_t h;
+
+    /* Descending priority queue. */
+    h = aghp_new( po, aghp_test_cmp, -1 );
+    aghp_ify( h );
+
+    prev = INT_MAX;
+    for ( int i = 0; i < lim; i++ ) {
+        cur = *( (int*)aghp_get( h ) );
+        TEST_ASSERT_TRUE( prev >= cur );
+        prev = cur;
+    }
+    TEST_ASSERT_TRUE( aghp_is_empty( h ) );
+
+    h = aghp_del( h );
+
+    /* Sort to ascending order. */
+    aghp_sort_postor( po, aghp_test_cmp, 1 );
+
+    prev = -1;
+    for ( int i = 0; i < lim; i++ ) {
+        cur = *( po_item( po, i, int* ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+
+    po_del( po );
+}
+
+
+void test_put_many( void )
+{
+    po_t po;
+    int  items[ 600 ];
+    po_d ptrs[ 600 ];
+    int  prev;
+    int  cur;
+
+    srand( 4321 );
+
+    for ( int i = 0; i < 600; i++ ) {
+        items[ i ] = rand_within( 1000 );
+        ptrs[ i ] = &items[ i ];
+    }
+
+    po = po_new_sized( NULL, 4 );
+
+    aghp_t h;
+    h = aghp_new( po, aghp_test_cmp, 1 );
+
+    /* Large batch is rebuilt, small batches are put separately. */
+    aghp_put_many( h, ptrs, 500 );
+    aghp_put_many( h, ptrs + 500, 10 );
+    aghp_put_many( h, ptrs + 510, 0 );
+    for ( int i = 510; i < 600; i += 30 ) {
+        aghp_put_many( h, ptrs + i, 30 );
+    }
+
+    prev = -1;
+    for ( int i = 0; i < 600; i++ ) {
+        cur = *( (int*)aghp_get( h ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+    TEST_ASSERT_TRUE( aghp_is_empty( h ) );
+
+    h = aghp_del( h );
+    po_del( po );
+}
+
+
+void test_topk( void )
+{
+    po_t        po;
+    po_t        sorted;
+    po_t        out;
+    int         items[ 1000 ];
+    aghp_topk_s ts;
+
+    srand( 5678 );
+
+    po = po_new_sized( NULL, 1000 );
+    sorted = po_new_sized( NULL, 1000 );
+    out = po_new_sized( NULL, 4 );
+
+    for ( int i = 0; i < 1000; i++ ) {
+        items[ i ] = rand_within( 300 );
+        po_push( po, &items[ i ] );
+        po_push( sorted, &items[ i ] );
+    }
+
+    for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+        aghp_sort_postor( sorted, aghp_test_cmp, dir );
+
+        /* Top-K matches the head of the full sort. */
+        po_size_t ks[] = { 0, 1, 7, 100, 1000, 2000 };
+        for ( int j = 0; j < 6; j++ ) {
+            aghp_topk( po, ks[ j ], aghp_test_cmp, dir, out );
+            TEST_ASSERT_TRUE( out->used == ( ks[ j ] < 1000 ? ks[ j ] : 1000 ) );
+            for ( po_size_t i = 0; i < out->used; i++ ) {
+                TEST_ASSERT_EQUAL( *po_item( sorted, i, int* ), *po_item( out, i, int* ) );
+            }
+        }
+
+        /* Streaming form. */
+        aghp_topk_init( &ts, out, 50, aghp_test_cmp, dir );
+        for ( int i = 0; i < 1000; i++ ) {
+            aghp_topk_put( &ts, &items[ i ] );
+        }
+        aghp_topk_done( &ts );
+        TEST_ASSERT_TRUE( out->used == 50 );
+        for ( po_size_t i = 0; i < 50; i++ ) {
+            TEST_ASSERT_EQUAL( *po_item( sorted, i, int* ), *po_item( out, i, int* ) );
+        }
+    }
+
+    po_del( po );
+    po_del( sorted );
+    po_del( out );
+}
+
+
+void test_pushpop_replace( void )
+{
+    po_t po;
+    int  items[ 500 ];
+    po_d out[ 500 ];
+    int  cur;
+    int  prev;
+    int  item;
+
+    srand( 8765 );
+
+    po = po_new_sized( NULL, 4 );
+
+    aghp_t h;
+    h = aghp_new( po, aghp_test_cmp, 1 );
+
+    TEST_ASSERT_NULL( aghp_peek( h ) );
+
+    /* Empty heap: pushpop returns item, replace puts it. */
+    item = 5;
+    TEST_ASSERT_EQUAL_PTR( &item, aghp_pushpop( h, &item ) );
+    TEST_ASSERT_TRUE( aghp_is_empty( h ) );
+    TEST_ASSERT_NULL( aghp_replace( h, &item ) );
+    TEST_ASSERT_EQUAL_PTR( &item, aghp_peek( h ) );
+    TEST_ASSERT_EQUAL_PTR( &item, aghp_get( h ) );
+
+    for ( int i = 0; i < 250; i++ ) {
+        items[ i ] = rand_within( 1000 );
+        aghp_put( h, &items[ i ] );
+    }
+
+    /* Pushpop returns the smallest of heap and item. */
+    for ( int i = 250; i < 500; i++ ) {
+        items[ i ] = rand_within( 1000 );
+        prev = *( (int*)aghp_peek( h ) );
+        cur = *( (int*)aghp_pushpop( h, &items[ i ] ) );
+        TEST_ASSERT_EQUAL( prev < items[ i ] ? prev : items[ i ], cur );
+    }
+
+    /* Replace returns the root, whatever the item is. */
+    for ( int i = 0; i < 100; i++ ) {
+        prev = *( (int*)aghp_peek( h ) );
+        cur = *( (int*)aghp_replace( h, &items[ i ] ) );
+        TEST_ASSERT_EQUAL( prev, cur );
+    }
+
+    TEST_ASSERT_TRUE( h->cnt == 250 );
+
+    /* Drain in batches. */
+    TEST_ASSERT_TRUE( aghp_get_many( h, 100, out ) == 100 );
+    TEST_ASSERT_TRUE( aghp_get_many( h, 400, out + 100 ) == 150 );
+    TEST_ASSERT_TRUE( aghp_get_many( h, 10, out + 250 ) == 0 );
+    TEST_ASSERT_TRUE( aghp_is_empty( h ) );
+
+    for ( int i = 1; i < 250; i++ ) {
+        TEST_ASSERT_TRUE( *( (int*)out[ i - 1 ] ) <= *( (int*)out[ i ] ) );
+    }
+
+    h = aghp_del( h );
+    po_del( po );
+}
+
+
+
+void test_stats_off( void )
+{
+    po_t         po;
+    int          items[ 100 ];
+    aghp_stats_s st;
+
+    po = po_new_sized( NULL, 100 );
+
+    aghp_t h;
+    h = aghp_new( po, aghp_test_cmp, 1 );
+
+    for ( int i = 0; i < 100; i++ ) {
+        items[ i ] = 100 - i;
+        aghp_put( h, &items[ i ] );
+    }
+    aghp_get( h );
+
+    /* Default build has no statistics (see test_heap_stats.c). */
+    memset( &st, 0xff, sizeof( st ) );
+    aghp_stats( h, &st );
+    TEST_ASSERT_TRUE( st.compares == 0 && st.moves == 0 && st.ops == 0 );
+    TEST_ASSERT_TRUE( st.max_depth == 0 && st.cycles == 0 );
+    aghp_stats_reset( h );
+
+    h = aghp_del( h );
+    po_del( po );
+}
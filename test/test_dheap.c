@@ -0,0 +1,280 @@
+#include "unity.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_dheap.h"
+
+
+/* ------------------------------------------------------------
+ * D-ary Heap tests:
+ */
+
+static int dheap_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+void test_dheap_put_get( void )
+{
+    po_t      po;
+    int       items[ 777 ];
+    po_size_t arity[] = { 2, 3, 4, 8, 16 };
+    int       prev;
+    int       cur;
+
+    srand( 1234 );
+
+    for ( int i = 0; i < 777; i++ ) {
+        items[ i ] = rand() % 300;
+    }
+
+    for ( size_t a = 0; a < sizeof( arity ) / sizeof( arity[ 0 ] ); a++ ) {
+
+        for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+            po = po_new_sized( NULL, 4 );
+
+            agdh_t h;
+            h = agdh_new( po, dheap_test_cmp, dir, arity[ a ] );
+            TEST_ASSERT_TRUE( agdh_arity( h ) >= arity[ a ] );
+
+            for ( int i = 0; i < 777; i++ ) {
+                agdh_put( h, &items[ i ] );
+            }
+
+            prev = dir > 0 ? -1 : INT_MAX;
+            for ( int i = 0; i < 777; i++ ) {
+                cur = *( (int*)agdh_get( h ) );
+                TEST_ASSERT_TRUE( dir > 0 ? prev <= cur : prev >= cur );
+                prev = cur;
+            }
+
+            TEST_ASSERT_TRUE( agdh_is_empty( h ) );
+            TEST_ASSERT_NULL( agdh_get( h ) );
+
+            h = agdh_del( h );
+            po_del( po );
+        }
+    }
+}
+
+
+void test_dheap_sort( void )
+{
+    po_t po;
+    int  items[ 1000 ];
+    int  prev;
+    int  cur;
+
+    srand( 4321 );
+
+    po = po_new_sized( NULL, 1000 );
+
+    for ( int i = 0; i < 1000; i++ ) {
+        items[ i ] = rand() % 500;
+        po_push( po, &items[ i ] );
+    }
+
+    /* Sort to ascending order. */
+    agdh_sort_postor( po, dheap_test_cmp, 1, 4 );
+
+    prev = -1;
+    for ( int i = 0; i < 1000; i++ ) {
+        cur = *( po_item( po, i, int* ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+
+    /* Sort to descending order. */
+    agdh_sort_postor( po, dheap_test_cmp, -1, 8 );
+
+    prev = INT_MAX;
+    for ( int i = 0; i < 1000; i++ ) {
+        cur = *( po_item( po, i, int* ) );
+        TEST_ASSERT_TRUE( prev >= cur );
+        prev = cur;
+    }
+
+    /* Heapify as priority queue. */
+    agdh_t h;
+    h = agdh_new( po, dheap_test_cmp, 1, 8 );
+    agdh_ify( h );
+
+    prev = -1;
+    for ( int i = 0; i < 1000; i++ ) {
+        cur = *( (int*)agdh_get( h ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+
+    agdh_set_polar( h, -1 );
+    TEST_ASSERT_TRUE( agdh_get_polar( h ) == -1 );
+
+    h = agdh_del( h );
+    po_del( po );
+}
+
+
+void test_dheap_align( void )
+{
+    po_t      po;
+    int       items[ 3000 ];
+    po_size_t arity[] = { 4, 8, 16 };
+    uintptr_t group;
+    int       prev;
+    int       cur;
+
+    srand( 5678 );
+
+    for ( int i = 0; i < 3000; i++ ) {
+        items[ i ] = rand() % 1000;
+    }
+
+    for ( size_t a = 0; a < sizeof( arity ) / sizeof( arity[ 0 ] ); a++ ) {
+
+        /* Group size in bytes, limited to cache line. */
+        group = arity[ a ] * sizeof( po_d );
+        if ( group > AGDH_CACHE_LINE )
+            group = AGDH_CACHE_LINE;
+
+        /* Postor grows (and moves) during puts. */
+        po = po_new_sized( NULL, 2 );
+
+        agdh_t h;
+        h = agdh_new( po, dheap_test_cmp, 1, arity[ a ] );
+
+        for ( int i = 0; i < 3000; i++ ) {
+            agdh_put( h, &items[ i ] );
+            TEST_ASSERT_TRUE( (uintptr_t)&po->data[ h->off + 1 ] % group == 0 );
+        }
+
+        prev = -1;
+        for ( int i = 0; i < 3000; i++ ) {
+            cur = *( (int*)agdh_get( h ) );
+            TEST_ASSERT_TRUE( prev <= cur );
+            prev = cur;
+        }
+
+        /* Heapify pads existing items, and sort removes padding. */
+        po->used = 0;
+        for ( int i = 0; i < 3000; i++ ) {
+            po_push( po, &items[ i ] );
+        }
+
+        agdh_init( h, po, dheap_test_cmp, -1, arity[ a ] );
+        agdh_ify_for_sort( h );
+        TEST_ASSERT_TRUE( (uintptr_t)&po->data[ h->off + 1 ] % group == 0 );
+        agdh_sort( h );
+
+        TEST_ASSERT_TRUE( po->used == 3000 );
+        prev = INT_MAX;
+        for ( int i = 0; i < 3000; i++ ) {
+            cur = *( po_item( po, i, int* ) );
+            TEST_ASSERT_TRUE( prev >= cur );
+            prev = cur;
+        }
+
+        h = agdh_del( h );
+        po_del( po );
+    }
+}
+
+
+void test_dheap_put_ify( void )
+{
+    po_t po;
+    int  items[ 100 ];
+    int  prev;
+    int  cur;
+
+    for ( int i = 0; i < 100; i++ ) {
+        items[ i ] = ( i * 37 ) % 100;
+    }
+
+    po = po_new_sized( NULL, 4 );
+
+    agdh_t h;
+    h = agdh_new( po, dheap_test_cmp, 1, 8 );
+
+    /* Put, get, append directly, and sort all. */
+    for ( int i = 0; i < 60; i++ ) {
+        agdh_put( h, &items[ i ] );
+    }
+    for ( int i = 0; i < 10; i++ ) {
+        agdh_get( h );
+    }
+    TEST_ASSERT_TRUE( po->used == h->off + 50 );
+    for ( int i = 60; i < 100; i++ ) {
+        po_push( po, &items[ i ] );
+    }
+
+    agdh_ify_for_sort( h );
+    TEST_ASSERT_TRUE( h->cnt == 90 );
+    agdh_sort( h );
+
+    TEST_ASSERT_TRUE( po->used == 90 );
+    prev = -1;
+    for ( int i = 0; i < 90; i++ ) {
+        cur = *( po_item( po, i, int* ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+
+    /* Put and heapify as priority queue. */
+    po->used = 0;
+    agdh_init( h, po, dheap_test_cmp, -1, 8 );
+    for ( int i = 0; i < 10; i++ ) {
+        agdh_put( h, &items[ i ] );
+    }
+    agdh_ify( h );
+    TEST_ASSERT_TRUE( h->cnt == 10 );
+
+    prev = INT_MAX;
+    for ( int i = 0; i < 10; i++ ) {
+        cur = *( (int*)agdh_get( h ) );
+        TEST_ASSERT_TRUE( prev >= cur );
+        prev = cur;
+    }
+    TEST_ASSERT_TRUE( agdh_is_empty( h ) );
+
+    h = agdh_del( h );
+    po_del( po );
+}
+
+
+void test_dheap_arity( void )
+{
+    po_t   po;
+    agdh_s hs;
+
+    po = po_new_sized( NULL, 4 );
+
+    agdh_init( &hs, po, dheap_test_cmp, 1, 0 );
+    TEST_ASSERT_TRUE( agdh_arity( &hs ) == 2 );
+    agdh_init( &hs, po, dheap_test_cmp, 1, 1 );
+    TEST_ASSERT_TRUE( agdh_arity( &hs ) == 2 );
+    agdh_init( &hs, po, dheap_test_cmp, 1, 5 );
+    TEST_ASSERT_TRUE( agdh_arity( &hs ) == 8 );
+    agdh_init( &hs, po, dheap_test_cmp, 1, AGDH_MAX_ARITY + 1 );
+    TEST_ASSERT_TRUE( agdh_arity( &hs ) == AGDH_MAX_ARITY );
+    agdh_init( &hs, po, dheap_test_cmp, 1, UINT64_MAX );
+    TEST_ASSERT_TRUE( agdh_arity( &hs ) == AGDH_MAX_ARITY );
+
+    po_del( po );
+}
@@ -0,0 +1,327 @@
+#include "unity.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ag_hash.h"
+
+
+/* ------------------------------------------------------------
+ * Hash tests:
+ */
+
+#define HASH_DATA_SIZE 1024
+
+static uint8_t hash_data[ HASH_DATA_SIZE ];
+
+
+static void hash_data_fill( void )
+{
+    srand( 1234 );
+
+    for ( int i = 0; i < HASH_DATA_SIZE; i++ ) {
+        hash_data[ i ] = (uint8_t)rand();
+    }
+}
+
+
+void test_streaming( void )
+{
+    aghs_state_s st;
+    size_t       chunks[] = { 1, 3, 7, 31, 32, 33, 100 };
+
+    hash_data_fill();
+
+    for ( size_t len = 0; len <= 300; len++ ) {
+
+        ag_hash_t ref = aghs_64_with_seed( hash_data, len, 77 );
+
+        for ( size_t c = 0; c < sizeof( chunks ) / sizeof( chunks[ 0 ] ); c++ ) {
+
+            aghs_64_init( &st, 77 );
+
+            for ( size_t pos = 0; pos < len; pos += chunks[ c ] ) {
+                size_t n = len - pos < chunks[ c ] ? len - pos : chunks[ c ];
+                aghs_64_update( &st, hash_data + pos, n );
+            }
+
+            TEST_ASSERT_TRUE( aghs_64_digest( &st ) == ref );
+        }
+    }
+
+    /* Reset gives seed-0 hash. */
+    aghs_64_init( &st, 0 );
+    aghs_64_update( &st, hash_data, HASH_DATA_SIZE );
+    TEST_ASSERT_TRUE( aghs_64_digest( &st ) == aghs_64( hash_data, HASH_DATA_SIZE ) );
+}
+
+
+void test_wide( void )
+{
+    static uint8_t   big[ 8192 + 3 ];
+    aghs_wide_impl_t impl[] = { aghs_wide_sse2, aghs_wide_avx2, aghs_wide_avx512 };
+    size_t           lens[] = { 0, 1, 63, 64, 65, 127, 128, 1023, 1024, 1025, 1088, 4096, 8192 };
+
+    srand( 4321 );
+    for ( size_t i = 0; i < sizeof( big ); i++ ) {
+        big[ i ] = (uint8_t)rand();
+    }
+
+    /* Short input is identical to aghs_64(). */
+    TEST_ASSERT_TRUE( aghs_wide_64( big, 63 ) == aghs_64( big, 63 ) );
+
+    for ( size_t l = 0; l < sizeof( lens ) / sizeof( lens[ 0 ] ); l++ ) {
+        for ( size_t off = 0; off < 4; off++ ) {
+
+            aghs_wide_select( aghs_wide_scalar );
+            ag_hash_t ref = aghs_wide_64_with_seed( big + off, lens[ l ], 99 );
+
+            for ( size_t i = 0; i < sizeof( impl ) / sizeof( impl[ 0 ] ); i++ ) {
+                /* Unsupported implementations fall back to supported ones. */
+                aghs_wide_select( impl[ i ] );
+                TEST_ASSERT_TRUE( aghs_wide_64_with_seed( big + off, lens[ l ], 99 ) == ref );
+            }
+        }
+    }
+
+    aghs_wide_select( aghs_wide_auto );
+    TEST_ASSERT_TRUE( aghs_wide_64( big, 8192 ) != aghs_wide_64( big + 1, 8192 ) );
+    TEST_ASSERT_TRUE( aghs_wide_64( big, 8192 ) != aghs_wide_64_with_seed( big, 8192, 1 ) );
+}
+
+
+void test_short( void )
+{
+    hash_data_fill();
+
+    for ( size_t len = 0; len <= 40; len++ ) {
+        for ( size_t off = 0; off < 8; off++ ) {
+            TEST_ASSERT_TRUE( aghs_64_short( hash_data + off, len ) ==
+                              aghs_64( hash_data + off, len ) );
+            TEST_ASSERT_TRUE( aghs_64_short_with_seed( hash_data + off, len, 5 ) ==
+                              aghs_64_with_seed( hash_data + off, len, 5 ) );
+        }
+    }
+
+    TEST_ASSERT_TRUE( aghs_64_short( NULL, 0 ) == aghs_64( NULL, 0 ) );
+}
+
+
+typedef struct
+{
+    const uint8_t* data;
+    size_t         len;
+} hash_key_s;
+
+
+static void hash_key( const po_d item, const void** key, size_t* length )
+{
+    *key = ( (hash_key_s*)item )->data;
+    *length = ( (hash_key_s*)item )->len;
+}
+
+
+void test_batch( void )
+{
+    const void* inputs[ 100 ];
+    size_t      lengths[ 100 ];
+    ag_hash_t   hashes[ 100 ];
+    hash_key_s  keys[ 100 ];
+    po_t        po;
+
+    hash_data_fill();
+
+    po = po_new_sized( NULL, 100 );
+
+    for ( int i = 0; i < 100; i++ ) {
+        inputs[ i ] = hash_data + i;
+        lengths[ i ] = (size_t)( i % 41 );
+        keys[ i ].data = hash_data + i;
+        keys[ i ].len = lengths[ i ];
+        po_push( po, &keys[ i ] );
+    }
+
+    aghs_64_batch( inputs, lengths, 100, 3, hashes );
+    for ( int i = 0; i < 100; i++ ) {
+        TEST_ASSERT_TRUE( hashes[ i ] == aghs_64_with_seed( inputs[ i ], lengths[ i ], 3 ) );
+    }
+
+    aghs_64_batch_postor( po, hash_key, 0, hashes );
+    for ( int i = 0; i < 100; i++ ) {
+        TEST_ASSERT_TRUE( hashes[ i ] == aghs_64( inputs[ i ], lengths[ i ] ) );
+    }
+
+    /* Short keys only, all lanes in lockstep. */
+    for ( int i = 0; i < 100; i++ ) {
+        lengths[ i ] = (size_t)( ( i * 13 ) % 32 );
+    }
+    aghs_64_batch( inputs, lengths, 96, 7, hashes );
+    for ( int i = 0; i < 96; i++ ) {
+        TEST_ASSERT_TRUE( hashes[ i ] == aghs_64_with_seed( inputs[ i ], lengths[ i ], 7 ) );
+    }
+
+    po_del( po );
+}
+
+
+void test_integer( void )
+{
+    uint32_t k32;
+    uint64_t k64;
+    uint64_t pair[ 2 ];
+    void*    ptr;
+
+    srand( 1234 );
+
+    for ( int i = 0; i < 100; i++ ) {
+        k32 = (uint32_t)rand();
+        k64 = ( (uint64_t)rand() << 32 ) ^ (uint64_t)rand();
+        pair[ 0 ] = k64;
+        pair[ 1 ] = ~k64 + i;
+        ptr = &pair[ i & 1 ];
+
+        TEST_ASSERT_TRUE( aghs_u32( k32 ) == aghs_64( &k32, sizeof( k32 ) ) );
+        TEST_ASSERT_TRUE( aghs_u64( k64 ) == aghs_64( &k64, sizeof( k64 ) ) );
+        TEST_ASSERT_TRUE( aghs_u64_pair( pair[ 0 ], pair[ 1 ] ) == aghs_64( pair, sizeof( pair ) ) );
+        TEST_ASSERT_TRUE( aghs_ptr( ptr ) == aghs_64( &ptr, sizeof( ptr ) ) );
+    }
+}
+
+
+void test_128( void )
+{
+    aghs_state_s st;
+    ag_hash128_t h;
+    ag_hash128_t prev;
+
+    hash_data_fill();
+
+    prev = aghs_128( hash_data, 0 );
+
+    for ( size_t len = 1; len <= 200; len++ ) {
+
+        h = aghs_128_with_seed( hash_data, len, 11 );
+        TEST_ASSERT_TRUE( h.lo == aghs_64_with_seed( hash_data, len, 11 ) );
+        TEST_ASSERT_TRUE( h.hi != h.lo );
+
+        aghs_64_init( &st, 11 );
+        for ( size_t pos = 0; pos < len; pos += 13 ) {
+            aghs_64_update( &st, hash_data + pos, len - pos < 13 ? len - pos : 13 );
+        }
+        TEST_ASSERT_TRUE( aghs_128_equal( aghs_128_digest( &st ), h ) );
+
+        h = aghs_128( hash_data, len );
+        TEST_ASSERT_FALSE( aghs_128_equal( h, prev ) );
+        prev = h;
+    }
+}
+
+
+void test_tree( void )
+{
+    size_t     len = 3 * AGHS_TREE_LEAF_SIZE + 1234;
+    uint8_t*   big = malloc( len );
+    ag_hash_t  leaf[ 4 ];
+    ag_hash_t  ref;
+
+    for ( size_t i = 0; i < len; i++ ) {
+        big[ i ] = (uint8_t)( i * 7 + ( i >> 11 ) );
+    }
+
+    for ( int i = 0; i < 4; i++ ) {
+        size_t pos = (size_t)i * AGHS_TREE_LEAF_SIZE;
+        leaf[ i ] = aghs_64_with_seed( big + pos, i < 3 ? AGHS_TREE_LEAF_SIZE : 1234, 5 );
+    }
+    ref = aghs_64_with_seed( leaf, sizeof( leaf ), 5 );
+
+    for ( int threads = 0; threads <= 8; threads++ ) {
+        TEST_ASSERT_TRUE( aghs_64_tree( big, len, 5, threads ) == ref );
+    }
+
+    /* Zero and negative thread counts are sequential. */
+    TEST_ASSERT_TRUE( aghs_64_tree( big, len, 5, 0 ) == ref );
+    TEST_ASSERT_TRUE( aghs_64_tree( big, len, 5, -1 ) == ref );
+    TEST_ASSERT_TRUE( aghs_64_tree( big, len, 5, INT_MIN ) == ref );
+
+    /* Single leaf. */
+    leaf[ 0 ] = aghs_64_with_seed( big, 100, 0 );
+    TEST_ASSERT_TRUE( aghs_64_tree( big, 100, 0, 4 ) == aghs_64( leaf, sizeof( ag_hash_t ) ) );
+
+    free( big );
+}
+
+
+void test_file( void )
+{
+    FILE*     fh;
+    ag_hash_t h;
+    int       fd[ 2 ];
+
+    hash_data_fill();
+
+    fh = tmpfile();
+    TEST_ASSERT_NOT_NULL( fh );
+
+    /* Empty file. */
+    TEST_ASSERT_TRUE( aghs_64_fd( fileno( fh ), &h ) == 0 );
+    TEST_ASSERT_TRUE( h == aghs_64( hash_data, 0 ) );
+
+    for ( int i = 0; i < 300; i++ ) {
+        fwrite( hash_data, 1, HASH_DATA_SIZE, fh );
+    }
+    fwrite( hash_data, 1, 7, fh );
+    fflush( fh );
+
+    /* Mapped file. */
+    TEST_ASSERT_TRUE( aghs_64_fd( fileno( fh ), &h ) == 0 );
+    {
+        aghs_state_s st;
+        aghs_64_init( &st, 0 );
+        for ( int i = 0; i < 300; i++ ) {
+            aghs_64_update( &st, hash_data, HASH_DATA_SIZE );
+        }
+        aghs_64_update( &st, hash_data, 7 );
+        TEST_ASSERT_TRUE( h == aghs_64_digest( &st ) );
+    }
+    fclose( fh );
+
+    /* Pipe is read in chunks. */
+    TEST_ASSERT_TRUE( pipe( fd ) == 0 );
+    TEST_ASSERT_TRUE( write( fd[ 1 ], hash_data, 500 ) == 500 );
+    close( fd[ 1 ] );
+    TEST_ASSERT_TRUE( aghs_64_fd( fd[ 0 ], &h ) == 0 );
+    TEST_ASSERT_TRUE( h == aghs_64( hash_data, 500 ) );
+    close( fd[ 0 ] );
+
+    TEST_ASSERT_TRUE( aghs_64_file( "/nonexistent/alogir", &h ) == -1 );
+}
+
+
+void test_crc( void )
+{
+    ag_hash_t hw;
+    ag_hash_t sw;
+    ag_hash_t prev = 0;
+
+    hash_data_fill();
+
+    for ( size_t len = 0; len <= 100; len++ ) {
+
+        aghs_crc_select( aghs_crc_soft );
+        sw = aghs_crc_64_with_seed( hash_data + 1, len, 0x123456789ULL );
+
+        /* Falls back to portable if SSE4.2 is missing. */
+        aghs_crc_select( aghs_crc_sse42 );
+        hw = aghs_crc_64_with_seed( hash_data + 1, len, 0x123456789ULL );
+
+        TEST_ASSERT_TRUE( hw == sw );
+        TEST_ASSERT_TRUE( hw != prev );
+        prev = hw;
+    }
+
+    aghs_crc_select( aghs_crc_auto );
+    TEST_ASSERT_TRUE( aghs_crc_64( hash_data, 8 ) != aghs_crc_64_with_seed( hash_data, 8, 1 ) );
+    TEST_ASSERT_TRUE( aghs_crc_64( hash_data, 8 ) != aghs_crc_64( hash_data + 1, 8 ) );
+}
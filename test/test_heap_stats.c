@@ -0,0 +1,105 @@
+#include "unity.h"
+
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_heap.h"
+
+
+/*
+ * Heap statistics tests. This file is built with AGHP_STATS (see
+ * project.yml), and the other Heap tests without it.
+ */
+#ifndef AGHP_STATS
+#error "test_heap_stats requires AGHP_STATS"
+#endif
+
+
+/* ------------------------------------------------------------
+ * Heap statistics tests:
+ */
+
+static int rand_within( int limit )
+{
+    if ( limit > 0 )
+        return ( rand() % limit );
+    else
+        return 0;
+}
+
+
+static int aghp_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+void test_stats( void )
+{
+    po_t         po;
+    int          items[ 1024 ];
+    aghp_stats_s st;
+    aghp_s       hs;
+
+    srand( 4321 );
+
+    po = po_new_sized( NULL, 1024 );
+
+    aghp_t h;
+    h = aghp_new( po, aghp_test_cmp, 1 );
+
+    aghp_stats( h, &st );
+    TEST_ASSERT_TRUE( st.compares == 0 && st.moves == 0 && st.ops == 0 );
+
+    for ( int i = 0; i < 1024; i++ ) {
+        items[ i ] = rand_within( 10000 );
+        aghp_put( h, &items[ i ] );
+    }
+    for ( int i = 0; i < 1024; i++ )
+        aghp_get( h );
+
+    aghp_stats( h, &st );
+    TEST_ASSERT_TRUE( st.ops == 2048 );
+    TEST_ASSERT_TRUE( st.compares > 2048 );
+    TEST_ASSERT_TRUE( st.moves >= 2048 );
+    TEST_ASSERT_TRUE( st.max_depth > 0 && st.max_depth <= 10 );
+
+    aghp_stats_reset( h );
+    aghp_stats( h, &st );
+    TEST_ASSERT_TRUE( st.compares == 0 && st.moves == 0 && st.ops == 0 );
+    TEST_ASSERT_TRUE( st.max_depth == 0 && st.cycles == 0 );
+
+    h = aghp_del( h );
+
+    /* Sort statistics with decomposed aghp_sort_postor(). */
+    po->used = 0;
+    for ( int i = 0; i < 1024; i++ )
+        po_push( po, &items[ i ] );
+
+    aghp_init( &hs, po, aghp_test_cmp, 1 );
+    aghp_ify_for_sort( &hs );
+    aghp_sort( &hs );
+    aghp_stats( &hs, &st );
+
+    for ( int i = 1; i < 1024; i++ ) {
+        TEST_ASSERT_TRUE( *( po_item( po, i - 1, int* ) ) <= *( po_item( po, i, int* ) ) );
+    }
+
+    /* Heapsort: at most about 2*n*log2(n) + 2*n compares. */
+    TEST_ASSERT_TRUE( st.compares > 1024 && st.compares <= 2 * 1024 * 10 + 2 * 1024 );
+    TEST_ASSERT_TRUE( st.moves >= 1024 );
+
+    po_del( po );
+}
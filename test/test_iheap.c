@@ -0,0 +1,139 @@
+#include "unity.h"
+
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_iheap.h"
+
+
+/* ------------------------------------------------------------
+ * Indexed Heap tests:
+ */
+
+static int iheap_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+void test_iheap_update_remove( void )
+{
+    po_t          po;
+    agih_t        h;
+    int           items[ 500 ];
+    agih_handle_t hnd[ 500 ];
+    int           prev;
+    int           cur;
+    po_size_t     cnt;
+
+    srand( 1234 );
+
+    po = po_new_sized( NULL, 4 );
+    h = agih_new( po, iheap_test_cmp, 1 );
+
+    TEST_ASSERT_NULL( agih_get( h ) );
+    TEST_ASSERT_NULL( agih_peek( h ) );
+    TEST_ASSERT_TRUE( agih_top( h ) == AGIH_NONE );
+
+    for ( int i = 0; i < 500; i++ ) {
+        items[ i ] = rand() % 1000;
+        hnd[ i ] = agih_put( h, &items[ i ] );
+        TEST_ASSERT_TRUE( agih_contains( h, hnd[ i ] ) );
+        TEST_ASSERT_EQUAL_PTR( &items[ i ], agih_item( h, hnd[ i ] ) );
+    }
+
+    /* Re-prioritize in both directions. */
+    for ( int i = 0; i < 500; i += 3 ) {
+        items[ i ] = rand() % 1000;
+        agih_update( h, hnd[ i ], &items[ i ] );
+    }
+
+    /* Remove some by handle. */
+    cnt = 500;
+    for ( int i = 1; i < 500; i += 7 ) {
+        TEST_ASSERT_EQUAL_PTR( &items[ i ], agih_remove( h, hnd[ i ] ) );
+        TEST_ASSERT_FALSE( agih_contains( h, hnd[ i ] ) );
+        cnt--;
+    }
+    TEST_ASSERT_TRUE( agih_cnt( h ) == cnt );
+
+    /* Handle stays stable, released handles are reused. */
+    for ( int i = 1; i < 500; i += 7 ) {
+        hnd[ i ] = agih_put( h, &items[ i ] );
+        cnt++;
+    }
+    TEST_ASSERT_TRUE( agih_cnt( h ) == 500 );
+    for ( int i = 0; i < 500; i++ ) {
+        TEST_ASSERT_EQUAL_PTR( &items[ i ], agih_item( h, hnd[ i ] ) );
+    }
+
+    prev = -1;
+    for ( int i = 0; i < 500; i++ ) {
+        TEST_ASSERT_EQUAL_PTR( agih_peek( h ), agih_item( h, agih_top( h ) ) );
+        cur = *( (int*)agih_get( h ) );
+        TEST_ASSERT_TRUE( prev <= cur );
+        prev = cur;
+    }
+
+    TEST_ASSERT_TRUE( agih_is_empty( h ) );
+    TEST_ASSERT_TRUE( po->used == 500 );
+
+    h = agih_del( h );
+    po_del( po );
+}
+
+
+void test_iheap_ify( void )
+{
+    po_t   po;
+    agih_t h;
+    int    items[ 300 ];
+    int    prev;
+    int    cur;
+
+    srand( 4321 );
+
+    po = po_new_sized( NULL, 300 );
+    for ( int i = 0; i < 300; i++ ) {
+        items[ i ] = rand() % 100;
+        po_push( po, &items[ i ] );
+    }
+
+    h = agih_new( po, iheap_test_cmp, -1 );
+    agih_ify( h );
+
+    /* Handle is the Postor index. */
+    TEST_ASSERT_EQUAL_PTR( &items[ 10 ], agih_item( h, 10 ) );
+
+    /* Increase-key to root. */
+    items[ 10 ] = 1000;
+    agih_update( h, 10, &items[ 10 ] );
+    TEST_ASSERT_TRUE( agih_top( h ) == 10 );
+
+    /* Decrease-key away from root. */
+    items[ 10 ] = -1;
+    agih_update( h, 10, &items[ 10 ] );
+
+    prev = 1000;
+    for ( int i = 0; i < 300; i++ ) {
+        cur = *( (int*)agih_get( h ) );
+        TEST_ASSERT_TRUE( prev >= cur );
+        prev = cur;
+    }
+    TEST_ASSERT_EQUAL( -1, prev );
+
+    h = agih_del( h );
+    po_del( po );
+}
@@ -0,0 +1,185 @@
+#include "unity.h"
+
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_heap.h"
+#include "ag_merge.h"
+
+
+/* ------------------------------------------------------------
+ * Merge tests:
+ */
+
+static int merge_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+static void merge_test_count( po_d item, void* arg )
+{
+    ( *( (po_size_t*)arg ) ) += *( (int*)item );
+}
+
+
+void test_merge_postors( void )
+{
+    po_t      in[ 70 ];
+    po_t      all;
+    po_t      out;
+    int*      items;
+    po_size_t ks[] = { 0, 1, 2, 3, 5, 64, 70 };
+    po_size_t cnt;
+    po_size_t sum;
+    po_size_t ref;
+    int       n;
+
+    srand( 1234 );
+
+    items = malloc( 70 * 100 * sizeof( int ) );
+    all = po_new_sized( NULL, 4 );
+    out = po_new_sized( NULL, 4 );
+
+    for ( int q = 0; q < 7; q++ ) {
+        for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+            /* Sorted inputs with random lengths (also empty). */
+            all->used = 0;
+            ref = 0;
+            n = 0;
+            for ( po_size_t s = 0; s < ks[ q ]; s++ ) {
+                in[ s ] = po_new_sized( NULL, 4 );
+                cnt = rand() % 100;
+                for ( po_size_t i = 0; i < cnt; i++ ) {
+                    items[ n ] = rand() % 500;
+                    po_push( in[ s ], &items[ n ] );
+                    po_push( all, &items[ n ] );
+                    ref += items[ n ];
+                    n++;
+                }
+                aghp_sort_postor( in[ s ], merge_test_cmp, dir );
+            }
+
+            aghp_sort_postor( all, merge_test_cmp, dir );
+
+            agmg_postor( in, ks[ q ], merge_test_cmp, dir, out );
+
+            TEST_ASSERT_TRUE( out->used == all->used );
+            for ( po_size_t i = 0; i < out->used; i++ ) {
+                TEST_ASSERT_EQUAL( *po_item( all, i, int* ), *po_item( out, i, int* ) );
+            }
+
+            /* Streaming callback. */
+            sum = 0;
+            cnt = agmg_postor_emit( in, ks[ q ], merge_test_cmp, dir, merge_test_count, &sum );
+            TEST_ASSERT_TRUE( cnt == all->used );
+            TEST_ASSERT_TRUE( sum == ref );
+
+            for ( po_size_t s = 0; s < ks[ q ]; s++ ) {
+                po_del( in[ s ] );
+            }
+        }
+    }
+
+    po_del( all );
+    po_del( out );
+    free( items );
+}
+
+
+/** Source of integers from "first" with "step" until "last". */
+typedef struct merge_test_seq_s
+{
+    int cur;
+    int step;
+    int last;
+    int buf[ 100 ];
+    int idx;
+} merge_test_seq_s;
+
+static po_d merge_test_seq_next( void* arg )
+{
+    merge_test_seq_s* s = (merge_test_seq_s*)arg;
+
+    if ( s->cur > s->last )
+        return NULL;
+
+    s->buf[ s->idx ] = s->cur;
+    s->cur += s->step;
+    return &s->buf[ s->idx++ ];
+}
+
+
+void test_merge_sources( void )
+{
+    merge_test_seq_s seq[ 3 ] = { { 0, 3, 60, { 0 }, 0 },
+                                  { 1, 3, 61, { 0 }, 0 },
+                                  { 2, 3, 62, { 0 }, 0 } };
+    agmg_source_s    src[ 3 ];
+    agmg_t           m;
+    po_d             item;
+
+    for ( int i = 0; i < 3; i++ ) {
+        src[ i ].next = merge_test_seq_next;
+        src[ i ].arg = &seq[ i ];
+    }
+
+    m = agmg_new( src, 3, merge_test_cmp, 1 );
+
+    for ( int i = 0; i <= 62; i++ ) {
+        TEST_ASSERT_EQUAL( i, *( (int*)agmg_peek( m ) ) );
+        item = agmg_get( m );
+        TEST_ASSERT_EQUAL( i, *( (int*)item ) );
+    }
+
+    TEST_ASSERT_NULL( agmg_peek( m ) );
+    TEST_ASSERT_NULL( agmg_get( m ) );
+
+    m = agmg_del( m );
+}
+
+
+void test_merge_stable( void )
+{
+    po_t in[ 4 ];
+    po_t out;
+    int  items[ 4 ][ 10 ];
+
+    out = po_new_sized( NULL, 4 );
+
+    /* Equal keys in all sources: output in source order. */
+    for ( int s = 0; s < 4; s++ ) {
+        in[ s ] = po_new_sized( NULL, 10 );
+        for ( int i = 0; i < 10; i++ ) {
+            items[ s ][ i ] = i / 5;
+            po_push( in[ s ], &items[ s ][ i ] );
+        }
+    }
+
+    agmg_postor( in, 4, merge_test_cmp, 1, out );
+
+    TEST_ASSERT_TRUE( out->used == 40 );
+    for ( po_size_t i = 1; i < 40; i++ ) {
+        if ( *po_item( out, i - 1, int* ) == *po_item( out, i, int* ) ) {
+            TEST_ASSERT_TRUE( po_item( out, i - 1, int* ) < po_item( out, i, int* ) );
+        }
+    }
+
+    for ( int s = 0; s < 4; s++ ) {
+        po_del( in[ s ] );
+    }
+    po_del( out );
+}
@@ -0,0 +1,183 @@
+#include "unity.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <postor.h>
+#include "ag_heap.h"
+#include "ag_mqueue.h"
+
+
+/* ------------------------------------------------------------
+ * MultiQueue tests:
+ */
+
+#define MQUEUE_TEST_THREADS 4
+#define MQUEUE_TEST_ITEMS 20000
+
+static int mqueue_test_items[ MQUEUE_TEST_THREADS * MQUEUE_TEST_ITEMS ];
+static int mqueue_test_seen[ MQUEUE_TEST_THREADS * MQUEUE_TEST_ITEMS ];
+
+
+static int mqueue_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+typedef struct mqueue_test_work_s
+{
+    agmq_t q;
+    int    id;
+    int    got;
+} mqueue_test_work_s;
+
+
+static void* mqueue_test_worker( void* arg )
+{
+    mqueue_test_work_s* w = (mqueue_test_work_s*)arg;
+    int*                item;
+
+    /* Mixed puts and gets. */
+    for ( int i = 0; i < MQUEUE_TEST_ITEMS; i++ ) {
+        agmq_put( w->q, &mqueue_test_items[ w->id * MQUEUE_TEST_ITEMS + i ] );
+        if ( i % 2 ) {
+            item = agmq_get( w->q );
+            if ( item ) {
+                __atomic_add_fetch(
+                    &mqueue_test_seen[ item - mqueue_test_items ], 1, __ATOMIC_RELAXED );
+                w->got++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+void test_mqueue_exact( void )
+{
+    agmq_t q;
+    int    items[ 1000 ];
+    int    prev;
+    int    cur;
+
+    srand( 1234 );
+
+    /* Single sub-heap is an exact priority queue. */
+    q = agmq_new( mqueue_test_cmp, -1, 1 );
+
+    TEST_ASSERT_NULL( agmq_get( q ) );
+
+    for ( int i = 0; i < 1000; i++ ) {
+        items[ i ] = rand() % 300;
+        agmq_put( q, &items[ i ] );
+    }
+
+    TEST_ASSERT_TRUE( agmq_cnt( q ) == 1000 );
+
+    prev = 300;
+    for ( int i = 0; i < 1000; i++ ) {
+        cur = *( (int*)agmq_get( q ) );
+        TEST_ASSERT_TRUE( prev >= cur );
+        prev = cur;
+    }
+
+    TEST_ASSERT_TRUE( agmq_is_empty( q ) );
+    TEST_ASSERT_NULL( agmq_get( q ) );
+
+    q = agmq_del( q );
+}
+
+
+void test_mqueue_relaxed( void )
+{
+    agmq_t q;
+    int    items[ 1000 ];
+    int    seen[ 1000 ];
+    int    cur;
+    long   early;
+
+    /* All items come out once, roughly in order. */
+    q = agmq_new( mqueue_test_cmp, 1, 8 );
+
+    for ( int i = 0; i < 1000; i++ ) {
+        items[ i ] = 999 - i;
+        seen[ i ] = 0;
+        agmq_put( q, &items[ i ] );
+    }
+
+    early = 0;
+    for ( int i = 0; i < 1000; i++ ) {
+        cur = *( (int*)agmq_get( q ) );
+        seen[ cur ]++;
+        early += abs( cur - i );
+    }
+
+    for ( int i = 0; i < 1000; i++ ) {
+        TEST_ASSERT_EQUAL( 1, seen[ i ] );
+    }
+
+    /* Average rank error is small compared to item count. */
+    TEST_ASSERT_TRUE( early / 1000 < 100 );
+
+    TEST_ASSERT_NULL( agmq_get( q ) );
+
+    q = agmq_del( q );
+}
+
+
+void test_mqueue_threads( void )
+{
+    agmq_t             q;
+    pthread_t          tid[ MQUEUE_TEST_THREADS ];
+    mqueue_test_work_s work[ MQUEUE_TEST_THREADS ];
+    int                got;
+    int*               item;
+
+    for ( int i = 0; i < MQUEUE_TEST_THREADS * MQUEUE_TEST_ITEMS; i++ ) {
+        mqueue_test_items[ i ] = rand() % 100000;
+        mqueue_test_seen[ i ] = 0;
+    }
+
+    q = agmq_new( mqueue_test_cmp, 1, 2 * MQUEUE_TEST_THREADS );
+
+    for ( int t = 0; t < MQUEUE_TEST_THREADS; t++ ) {
+        work[ t ].q = q;
+        work[ t ].id = t;
+        work[ t ].got = 0;
+        pthread_create( &tid[ t ], NULL, mqueue_test_worker, &work[ t ] );
+    }
+
+    got = 0;
+    for ( int t = 0; t < MQUEUE_TEST_THREADS; t++ ) {
+        pthread_join( tid[ t ], NULL );
+        got += work[ t ].got;
+    }
+
+    TEST_ASSERT_TRUE( agmq_cnt( q )
+                      == (po_size_t)( MQUEUE_TEST_THREADS * MQUEUE_TEST_ITEMS - got ) );
+
+    /* Drain the rest. */
+    while ( ( item = agmq_get( q ) ) != NULL ) {
+        mqueue_test_seen[ item - mqueue_test_items ]++;
+    }
+
+    for ( int i = 0; i < MQUEUE_TEST_THREADS * MQUEUE_TEST_ITEMS; i++ ) {
+        TEST_ASSERT_EQUAL( 1, mqueue_test_seen[ i ] );
+    }
+
+    q = agmq_del( q );
+}
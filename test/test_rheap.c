@@ -0,0 +1,118 @@
+#include "unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_rheap.h"
+
+
+/* ------------------------------------------------------------
+ * Radix Heap tests:
+ */
+
+static uint64_t rheap_test_key( const po_d item )
+{
+    return *( (uint64_t*)item );
+}
+
+
+void test_rheap_monotone( void )
+{
+    agrh_t   h;
+    uint64_t items[ 2000 ];
+    uint64_t now;
+    uint64_t prev;
+    uint64_t cur;
+    int      put;
+    int      got;
+
+    srand( 1234 );
+
+    h = agrh_new( rheap_test_key );
+
+    TEST_ASSERT_TRUE( agrh_is_empty( h ) );
+    TEST_ASSERT_NULL( agrh_get( h ) );
+    TEST_ASSERT_NULL( agrh_peek( h ) );
+
+    /* Timer style: new keys are in the future of the last one. */
+    prev = 0;
+    put = 0;
+    got = 0;
+    while ( got < 2000 ) {
+
+        if ( put < 2000 && ( agrh_is_empty( h ) || rand() % 3 != 0 ) ) {
+            now = agrh_last( h );
+            items[ put ] = now + ( rand() % 5 == 0 ? 0 : (uint64_t)rand() << ( rand() % 24 ) );
+            agrh_put( h, &items[ put ] );
+            put++;
+        } else {
+            cur = *( (uint64_t*)agrh_peek( h ) );
+            TEST_ASSERT_EQUAL_UINT64( cur, *( (uint64_t*)agrh_get( h ) ) );
+            TEST_ASSERT_TRUE( prev <= cur );
+            TEST_ASSERT_EQUAL_UINT64( cur, agrh_last( h ) );
+            prev = cur;
+            got++;
+        }
+    }
+
+    TEST_ASSERT_TRUE( agrh_is_empty( h ) );
+    TEST_ASSERT_TRUE( agrh_cnt( h ) == 0 );
+
+    h = agrh_del( h );
+}
+
+
+void test_rheap_wide_keys( void )
+{
+    agrh_s   hs;
+    uint64_t items[] = { UINT64_MAX, 0, 1, UINT64_MAX - 1, 1ULL << 63, 5, 5, 0 };
+    uint64_t sorted[] = { 0, 0, 1, 5, 5, 1ULL << 63, UINT64_MAX - 1, UINT64_MAX };
+
+    agrh_init( &hs, rheap_test_key );
+
+    for ( int i = 0; i < 8; i++ )
+        agrh_put( &hs, &items[ i ] );
+
+    TEST_ASSERT_TRUE( agrh_cnt( &hs ) == 8 );
+
+    for ( int i = 0; i < 8; i++ )
+        TEST_ASSERT_EQUAL_UINT64( sorted[ i ], *( (uint64_t*)agrh_get( &hs ) ) );
+
+    agrh_deinit( &hs );
+}
+
+
+void test_rheap_peek( void )
+{
+    agrh_s   hs;
+    uint64_t items[] = { 10, 100, 50, 70 };
+
+    agrh_init( &hs, rheap_test_key );
+
+    agrh_put( &hs, &items[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT64( 10, *( (uint64_t*)agrh_get( &hs ) ) );
+
+    /* Peek does not raise the smallest allowed key. */
+    agrh_put( &hs, &items[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT64( 100, *( (uint64_t*)agrh_peek( &hs ) ) );
+    TEST_ASSERT_EQUAL_UINT64( 10, agrh_last( &hs ) );
+
+    agrh_put( &hs, &items[ 2 ] );
+    agrh_put( &hs, &items[ 3 ] );
+    TEST_ASSERT_EQUAL_UINT64( 50, *( (uint64_t*)agrh_peek( &hs ) ) );
+
+    TEST_ASSERT_EQUAL_UINT64( 50, *( (uint64_t*)agrh_get( &hs ) ) );
+    TEST_ASSERT_EQUAL_UINT64( 70, *( (uint64_t*)agrh_get( &hs ) ) );
+    TEST_ASSERT_EQUAL_UINT64( 100, *( (uint64_t*)agrh_get( &hs ) ) );
+    TEST_ASSERT_EQUAL_UINT64( 100, agrh_last( &hs ) );
+    TEST_ASSERT_TRUE( agrh_is_empty( &hs ) );
+
+    /* Key below the last returned key is rejected. */
+    TEST_ASSERT_TRUE( agrh_put( &hs, &items[ 3 ] ) == -1 );
+    TEST_ASSERT_TRUE( agrh_is_empty( &hs ) );
+    TEST_ASSERT_TRUE( agrh_put( &hs, &items[ 1 ] ) == 0 );
+    TEST_ASSERT_EQUAL_UINT64( 100, *( (uint64_t*)agrh_get( &hs ) ) );
+
+    agrh_deinit( &hs );
+}
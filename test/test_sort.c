@@ -0,0 +1,236 @@
+#include "unity.h"
+
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_heap.h"
+#include "ag_sort.h"
+
+
+/* ------------------------------------------------------------
+ * Sort tests:
+ */
+
+static int sort_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+static void sort_test_check( po_t po, po_pos_t dir )
+{
+    for ( po_size_t i = 1; i < po->used; i++ ) {
+        TEST_ASSERT_TRUE( dir * sort_test_cmp( po->data[ i - 1 ], po->data[ i ] ) <= 0 );
+    }
+}
+
+
+/** Fill items with a pattern. */
+static void sort_test_fill( int* items, int cnt, int pattern )
+{
+    for ( int i = 0; i < cnt; i++ ) {
+        switch ( pattern ) {
+            case 0: items[ i ] = rand(); break;
+            case 1: items[ i ] = i; break;
+            case 2: items[ i ] = cnt - i; break;
+            case 3: items[ i ] = 7; break;
+            case 4: items[ i ] = rand() % 4; break;
+            case 5: items[ i ] = i < cnt / 2 ? i : cnt - i; break;
+            default: items[ i ] = ( i % 2 ) ? i : -i; break;
+        }
+    }
+}
+
+
+void test_sort_patterns( void )
+{
+    po_t po;
+    int* items;
+    int  sizes[] = { 0, 1, 2, 3, 10, 24, 25, 100, 129, 1000, 20000 };
+    long sum;
+
+    srand( 1234 );
+
+    items = malloc( 20000 * sizeof( int ) );
+    po = po_new_sized( NULL, 4 );
+
+    for ( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); s++ ) {
+        for ( int pattern = 0; pattern < 7; pattern++ ) {
+            for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+                sort_test_fill( items, sizes[ s ], pattern );
+
+                po->used = 0;
+                sum = 0;
+                for ( int i = 0; i < sizes[ s ]; i++ ) {
+                    po_push( po, &items[ i ] );
+                    sum += items[ i ];
+                }
+
+                agst_sort( po, sort_test_cmp, dir );
+
+                TEST_ASSERT_TRUE( po->used == (po_size_t)sizes[ s ] );
+                sort_test_check( po, dir );
+
+                /* Same items, i.e. a permutation. */
+                for ( po_size_t i = 0; i < po->used; i++ ) {
+                    sum -= *po_item( po, i, int* );
+                }
+                TEST_ASSERT_TRUE( sum == 0 );
+            }
+        }
+    }
+
+    po_del( po );
+    free( items );
+}
+
+
+void test_sort_array( void )
+{
+    int  items[ 300 ];
+    po_d data[ 300 ];
+    po_t po;
+
+    srand( 4321 );
+
+    po = po_new_sized( NULL, 300 );
+
+    for ( int i = 0; i < 300; i++ ) {
+        items[ i ] = rand() % 100;
+        data[ i ] = &items[ i ];
+        po_push( po, &items[ i ] );
+    }
+
+    /* Same result as Heap sort. */
+    agst_sort_array( data, 300, sort_test_cmp, -1 );
+    aghp_sort_postor( po, sort_test_cmp, -1 );
+
+    for ( int i = 0; i < 300; i++ ) {
+        TEST_ASSERT_EQUAL( *po_item( po, i, int* ), *( (int*)data[ i ] ) );
+    }
+
+    po_del( po );
+}
+
+
+void test_sort_parallel( void )
+{
+    po_t po;
+    int* items;
+    int  threads[] = { 0, 2, 3, 4, 7, 8 };
+    int  sizes[] = { 5, 1000, 54321 };
+    long sum;
+
+    srand( 5678 );
+
+    items = malloc( 54321 * sizeof( int ) );
+    po = po_new_sized( NULL, 4 );
+
+    for ( int s = 0; s < 3; s++ ) {
+        for ( int t = 0; t < 6; t++ ) {
+            for ( int pattern = 0; pattern < 7; pattern += 2 ) {
+                for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+                    sort_test_fill( items, sizes[ s ], pattern );
+
+                    po->used = 0;
+                    sum = 0;
+                    for ( int i = 0; i < sizes[ s ]; i++ ) {
+                        po_push( po, &items[ i ] );
+                        sum += items[ i ];
+                    }
+
+                    /* Small cutoff to force the parallel path. */
+                    agst_sort_parallel( po, sort_test_cmp, dir, threads[ t ], 16 );
+
+                    TEST_ASSERT_TRUE( po->used == (po_size_t)sizes[ s ] );
+                    sort_test_check( po, dir );
+
+                    for ( po_size_t i = 0; i < po->used; i++ ) {
+                        sum -= *po_item( po, i, int* );
+                    }
+                    TEST_ASSERT_TRUE( sum == 0 );
+                }
+            }
+        }
+    }
+
+    po_del( po );
+    free( items );
+}
+
+
+static uint64_t sort_test_key( const po_d item )
+{
+    /* Signed to unsigned order. */
+    return (uint64_t)( *( (int*)item ) ) ^ ( (uint64_t)1 << 63 );
+}
+
+
+void test_sort_radix( void )
+{
+    po_t po;
+    int* items;
+    int  sizes[] = { 0, 1, 2, 100, 20000 };
+    long sum;
+
+    srand( 8765 );
+
+    items = malloc( 20000 * sizeof( int ) );
+    po = po_new_sized( NULL, 4 );
+
+    for ( int s = 0; s < 5; s++ ) {
+        for ( int pattern = 0; pattern < 7; pattern++ ) {
+            for ( po_pos_t dir = -1; dir <= 1; dir += 2 ) {
+
+                sort_test_fill( items, sizes[ s ], pattern );
+
+                po->used = 0;
+                sum = 0;
+                for ( int i = 0; i < sizes[ s ]; i++ ) {
+                    po_push( po, &items[ i ] );
+                    sum += items[ i ];
+                }
+
+                TEST_ASSERT_EQUAL( 0, agst_radix( po, sort_test_key, dir ) );
+
+                TEST_ASSERT_TRUE( po->used == (po_size_t)sizes[ s ] );
+                sort_test_check( po, dir );
+
+                for ( po_size_t i = 0; i < po->used; i++ ) {
+                    sum -= *po_item( po, i, int* );
+                }
+                TEST_ASSERT_TRUE( sum == 0 );
+            }
+        }
+    }
+
+    /* Stable: equal keys keep their Postor order. */
+    po->used = 0;
+    for ( int i = 0; i < 1000; i++ ) {
+        items[ i ] = rand() % 10;
+        po_push( po, &items[ i ] );
+    }
+    agst_radix( po, sort_test_key, 1 );
+    for ( po_size_t i = 1; i < po->used; i++ ) {
+        if ( *po_item( po, i - 1, int* ) == *po_item( po, i, int* ) ) {
+            TEST_ASSERT_TRUE( po_item( po, i - 1, int* ) < po_item( po, i, int* ) );
+        }
+    }
+
+    po_del( po );
+    free( items );
+}
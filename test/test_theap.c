@@ -0,0 +1,107 @@
+#include "unity.h"
+
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_theap.h"
+
+
+/* ------------------------------------------------------------
+ * Typed Heap tests:
+ */
+
+AGHP_DEFINE( theap_int, int, int, a < b )
+AGHP_DEFINE( theap_dbl, double, void*, a > b )
+
+
+void test_theap_put_get( void )
+{
+    theap_int_t h;
+    int         key;
+    int         val = 0;
+    int         prev = 0;
+
+    srand( 1234 );
+
+    h = theap_int_new( 0 );
+
+    TEST_ASSERT_TRUE( theap_int_is_empty( h ) );
+    TEST_ASSERT_FALSE( theap_int_get( h, &key, &val ) );
+
+    for ( int i = 0; i < 1000; i++ ) {
+        key = rand() % 300;
+        theap_int_put( h, key, key * 2 );
+    }
+
+    TEST_ASSERT_EQUAL( 1000, theap_int_cnt( h ) );
+
+    TEST_ASSERT_TRUE( theap_int_peek( h, &prev, NULL ) );
+    for ( int i = 0; i < 1000; i++ ) {
+        TEST_ASSERT_TRUE( theap_int_get( h, &key, &val ) );
+        TEST_ASSERT_TRUE( prev <= key );
+        TEST_ASSERT_EQUAL( key * 2, val );
+        prev = key;
+    }
+
+    TEST_ASSERT_TRUE( theap_int_is_empty( h ) );
+
+    h = theap_int_del( h );
+}
+
+
+void test_theap_ify_sort( void )
+{
+    theap_dbl_t h;
+    double      keys[ 777 ];
+    double      key = 0;
+    void*       val = NULL;
+    double      prev;
+
+    srand( 4321 );
+
+    h = theap_dbl_new( 16 );
+
+    for ( int i = 0; i < 777; i++ ) {
+        keys[ i ] = (double)( rand() % 500 ) / 7.0;
+        theap_dbl_push( h, keys[ i ], &keys[ i ] );
+    }
+
+    /* Max-at-root priority queue. */
+    theap_dbl_ify( h );
+
+    prev = 1e9;
+    for ( int i = 0; i < 777; i++ ) {
+        TEST_ASSERT_TRUE( theap_dbl_get( h, &key, &val ) );
+        TEST_ASSERT_TRUE( prev >= key );
+        TEST_ASSERT_TRUE( *( (double*)val ) == key );
+        prev = key;
+    }
+
+    /* Sort to "less_expr" (decending) order. */
+    for ( int i = 0; i < 777; i++ ) {
+        theap_dbl_push( h, keys[ i ], &keys[ i ] );
+    }
+
+    theap_dbl_sort( h );
+
+    TEST_ASSERT_EQUAL( 777, theap_dbl_cnt( h ) );
+    for ( int i = 1; i < 777; i++ ) {
+        TEST_ASSERT_TRUE( h->key[ i - 1 ] >= h->key[ i ] );
+        TEST_ASSERT_TRUE( *( (double*)h->val[ i ] ) == h->key[ i ] );
+    }
+
+    h = theap_dbl_del( h );
+
+    /* Trivial sizes. */
+    theap_int_s hs;
+    theap_int_init( &hs, 1 );
+    theap_int_sort( &hs );
+    theap_int_push( &hs, 5, 0 );
+    theap_int_sort( &hs );
+    TEST_ASSERT_EQUAL( 5, hs.key[ 0 ] );
+    theap_int_push( &hs, 3, 0 );
+    theap_int_sort( &hs );
+    TEST_ASSERT_EQUAL( 3, hs.key[ 0 ] );
+    TEST_ASSERT_EQUAL( 5, hs.key[ 1 ] );
+    theap_int_deinit( &hs );
+}
@@ -0,0 +1,197 @@
+#include "unity.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_timer.h"
+
+
+/* ------------------------------------------------------------
+ * Timer tests:
+ */
+
+#define TIMER_TEST_CNT 5000
+
+typedef struct timer_test_s
+{
+    agtm_entry_s entry;
+    uint64_t     fired;
+    int          cancelled;
+    int          count;
+} timer_test_s;
+
+static uint64_t timer_test_now;
+
+static void timer_test_expire( agtm_entry_t e, void* arg )
+{
+    timer_test_s* tt;
+    po_size_t*    cnt;
+
+    tt = (timer_test_s*)e->data;
+    cnt = (po_size_t*)arg;
+
+    tt->fired = timer_test_now;
+    tt->count++;
+    ( *cnt )++;
+}
+
+
+static void timer_test_run( uint64_t tick, po_size_t levels, uint64_t range )
+{
+    agtm_t        w;
+    timer_test_s* tt;
+    uint64_t      start;
+    po_size_t     cnt;
+    po_size_t     expected;
+
+    tt = malloc( TIMER_TEST_CNT * sizeof( timer_test_s ) );
+
+    start = 12345;
+    timer_test_now = start;
+    w = agtm_new( tick, levels, start );
+
+    for ( int i = 0; i < TIMER_TEST_CNT; i++ ) {
+        agtm_entry_init( &tt[ i ].entry, &tt[ i ] );
+        tt[ i ].fired = 0;
+        tt[ i ].cancelled = 0;
+        tt[ i ].count = 0;
+        agtm_schedule( w, &tt[ i ].entry, start + (uint64_t)rand() % range );
+        TEST_ASSERT_TRUE( agtm_is_scheduled( &tt[ i ].entry ) );
+    }
+
+    TEST_ASSERT_TRUE( agtm_cnt( w ) == TIMER_TEST_CNT );
+
+    /* Cancel and re-schedule some. */
+    expected = TIMER_TEST_CNT;
+    for ( int i = 0; i < TIMER_TEST_CNT; i += 3 ) {
+        TEST_ASSERT_TRUE( agtm_cancel( w, &tt[ i ].entry ) );
+        TEST_ASSERT_FALSE( agtm_cancel( w, &tt[ i ].entry ) );
+        tt[ i ].cancelled = 1;
+        expected--;
+    }
+    for ( int i = 1; i < TIMER_TEST_CNT; i += 3 ) {
+        agtm_schedule( w, &tt[ i ].entry, start + (uint64_t)rand() % range );
+    }
+
+    TEST_ASSERT_TRUE( agtm_cnt( w ) == expected );
+
+    /* Advance in random steps. */
+    cnt = 0;
+    while ( timer_test_now < start + range + tick ) {
+        timer_test_now += 1 + (uint64_t)rand() % ( range / 50 + 1 );
+        agtm_advance( w, timer_test_now, timer_test_expire, &cnt );
+    }
+
+    TEST_ASSERT_TRUE( cnt == expected );
+    TEST_ASSERT_TRUE( agtm_cnt( w ) == 0 );
+
+    for ( int i = 0; i < TIMER_TEST_CNT; i++ ) {
+        if ( tt[ i ].cancelled ) {
+            TEST_ASSERT_EQUAL( 0, tt[ i ].count );
+        } else {
+            TEST_ASSERT_EQUAL( 1, tt[ i ].count );
+            TEST_ASSERT_FALSE( agtm_is_scheduled( &tt[ i ].entry ) );
+            /* Never early, and late at most one advance step plus tick. */
+            TEST_ASSERT_TRUE( tt[ i ].fired >= tt[ i ].entry.expire );
+            TEST_ASSERT_TRUE( tt[ i ].fired
+                              < tt[ i ].entry.expire + range / 50 + 1 + tick );
+        }
+    }
+
+    w = agtm_del( w );
+    free( tt );
+}
+
+
+void test_timer_levels( void )
+{
+    srand( 1234 );
+
+    /* Within the wheel range. */
+    timer_test_run( 1, 4, 100000 );
+    timer_test_run( 10, 3, 1000000 );
+
+    /* Beyond the wheel range (parked timers). */
+    timer_test_run( 1, 1, 10000 );
+    timer_test_run( 3, 2, 100000 );
+}
+
+
+static void timer_test_resched( agtm_entry_t e, void* arg )
+{
+    agtm_t w;
+
+    w = (agtm_t)arg;
+
+    if ( *( (int*)e->data ) > 0 ) {
+        ( *( (int*)e->data ) )--;
+        agtm_schedule( w, e, e->expire + 100 );
+    }
+}
+
+
+void test_timer_resched( void )
+{
+    agtm_s       ws;
+    agtm_entry_s e;
+    int          left;
+    po_size_t    cnt;
+
+    agtm_init( &ws, 1, 3, 0 );
+
+    left = 10;
+    agtm_entry_init( &e, &left );
+    agtm_schedule( &ws, &e, 50 );
+
+    /* Nothing is due. */
+    TEST_ASSERT_TRUE( agtm_advance( &ws, 49, timer_test_resched, &ws ) == 0 );
+
+    /* Periodic timer re-schedules itself in callback. */
+    cnt = 0;
+    for ( uint64_t now = 50; now <= 2000; now += 50 )
+        cnt += agtm_advance( &ws, now, timer_test_resched, &ws );
+
+    TEST_ASSERT_TRUE( cnt == 11 );
+    TEST_ASSERT_EQUAL( 0, left );
+    TEST_ASSERT_FALSE( agtm_is_scheduled( &e ) );
+
+    /* Past expiry fires at next advance. */
+    agtm_schedule( &ws, &e, 10 );
+    TEST_ASSERT_TRUE( agtm_advance( &ws, 2001, timer_test_resched, &ws ) == 1 );
+
+    agtm_deinit( &ws );
+}
+
+
+void test_timer_past( void )
+{
+    agtm_t       w;
+    timer_test_s tt;
+    po_size_t    cnt;
+
+    /* Tick of 10 units, current tick covers 1000..1009. */
+    timer_test_now = 1005;
+    w = agtm_new( 10, 2, timer_test_now );
+
+    agtm_entry_init( &tt.entry, &tt );
+    tt.count = 0;
+
+    /* Expiry now and in the past: not within the current tick. */
+    cnt = 0;
+    agtm_schedule( w, &tt.entry, timer_test_now );
+    TEST_ASSERT_TRUE( agtm_advance( w, timer_test_now, timer_test_expire, &cnt ) == 0 );
+    TEST_ASSERT_TRUE( agtm_advance( w, 1009, timer_test_expire, &cnt ) == 0 );
+    TEST_ASSERT_TRUE( agtm_is_scheduled( &tt.entry ) );
+
+    agtm_schedule( w, &tt.entry, 10 );
+    TEST_ASSERT_TRUE( agtm_advance( w, 1009, timer_test_expire, &cnt ) == 0 );
+
+    /* Expires at the next tick boundary. */
+    timer_test_now = 1010;
+    TEST_ASSERT_TRUE( agtm_advance( w, timer_test_now, timer_test_expire, &cnt ) == 1 );
+    TEST_ASSERT_TRUE( tt.count == 1 && tt.fired == 1010 );
+    TEST_ASSERT_FALSE( agtm_is_scheduled( &tt.entry ) );
+
+    w = agtm_del( w );
+}
@@ -0,0 +1,272 @@
+#include "unity.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <postor.h>
+#include "ag_sort.h"
+#include "ag_heap.h"
+#include "ag_merge.h"
+#include "ag_xsort.h"
+
+
+/* ------------------------------------------------------------
+ * External Sort tests:
+ */
+
+typedef struct xsort_test_s
+{
+    int*      input;
+    po_size_t cnt;
+    po_size_t pos;
+    long      live;
+    int       prev;
+    po_size_t out;
+    int       sorted;
+    int       fail_write;
+    int       max_fds;
+} xsort_test_s;
+
+
+static int xsort_test_fds( void )
+{
+    int cnt = 0;
+
+    for ( int fd = 0; fd < 1024; fd++ ) {
+        if ( fcntl( fd, F_GETFD ) != -1 )
+            cnt++;
+    }
+
+    return cnt;
+}
+
+
+static int xsort_test_cmp( const po_d a, const po_d b )
+{
+    int ai;
+    int bi;
+
+    ai = *( (int*)a );
+    bi = *( (int*)b );
+
+    if ( ai > bi ) {
+        return 1;
+    } else if ( bi > ai ) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+
+static po_d xsort_test_input( void* arg )
+{
+    xsort_test_s* t = (xsort_test_s*)arg;
+    int*          item;
+
+    if ( t->pos >= t->cnt )
+        return NULL;
+
+    item = malloc( sizeof( int ) );
+    *item = t->input[ t->pos++ ];
+    t->live++;
+
+    return item;
+}
+
+
+static int xsort_test_write( FILE* fh, const po_d item, void* arg )
+{
+    xsort_test_s* t = (xsort_test_s*)arg;
+
+    if ( t->fail_write && t->pos > t->cnt / 2 )
+        return -1;
+
+    if ( t->max_fds >= 0 ) {
+        int fds = xsort_test_fds();
+        if ( fds > t->max_fds )
+            t->max_fds = fds;
+    }
+
+    if ( fwrite( item, sizeof( int ), 1, fh ) != 1 )
+        return -1;
+    else
+        return 0;
+}
+
+
+static po_d xsort_test_read( FILE* fh, void* arg )
+{
+    xsort_test_s* t = (xsort_test_s*)arg;
+    int           val;
+    int*          item;
+
+    if ( fread( &val, sizeof( int ), 1, fh ) != 1 )
+        return NULL;
+
+    item = malloc( sizeof( int ) );
+    *item = val;
+    t->live++;
+
+    return item;
+}
+
+
+static void xsort_test_free( po_d item, void* arg )
+{
+    xsort_test_s* t = (xsort_test_s*)arg;
+
+    free( item );
+    t->live--;
+}
+
+
+static size_t xsort_test_size( const po_d item, void* arg )
+{
+    (void)item;
+    (void)arg;
+    return sizeof( int );
+}
+
+
+static void xsort_test_emit( po_d item, void* arg )
+{
+    xsort_test_s* t = (xsort_test_s*)arg;
+    int           val;
+
+    val = *( (int*)item );
+    if ( t->out > 0 && val < t->prev )
+        t->sorted = 0;
+    t->prev = val;
+    t->out++;
+
+    xsort_test_free( item, arg );
+}
+
+
+static void xsort_test_setup( agxs_conf_t conf, xsort_test_s* t, po_size_t cnt )
+{
+    t->input = malloc( cnt * sizeof( int ) );
+    for ( po_size_t i = 0; i < cnt; i++ ) {
+        t->input[ i ] = rand() % 10000;
+    }
+    t->cnt = cnt;
+    t->pos = 0;
+    t->live = 0;
+    t->prev = 0;
+    t->out = 0;
+    t->sorted = 1;
+    t->fail_write = 0;
+    t->max_fds = -1;
+
+    agxs_conf_init( conf );
+    conf->cmp = xsort_test_cmp;
+    conf->dir = 1;
+    conf->input = xsort_test_input;
+    conf->write = xsort_test_write;
+    conf->read = xsort_test_read;
+    conf->free = xsort_test_free;
+    conf->size = xsort_test_size;
+    conf->emit = xsort_test_emit;
+    conf->arg = t;
+}
+
+
+void test_xsort_passes( void )
+{
+    agxs_conf_s  conf;
+    xsort_test_s t;
+
+    srand( 1234 );
+
+    /* In memory only. */
+    xsort_test_setup( &conf, &t, 1000 );
+    conf.memory = 1024 * 1024;
+    TEST_ASSERT_EQUAL( 0, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.out == 1000 );
+    TEST_ASSERT_TRUE( t.sorted );
+    TEST_ASSERT_TRUE( t.live == 0 );
+    free( t.input );
+
+    /* Single merge pass, tmpfile(). */
+    xsort_test_setup( &conf, &t, 10000 );
+    conf.memory = 1000 * ( sizeof( int ) + sizeof( po_d ) );
+    TEST_ASSERT_EQUAL( 0, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.out == 10000 );
+    TEST_ASSERT_TRUE( t.sorted );
+    TEST_ASSERT_TRUE( t.live == 0 );
+    free( t.input );
+
+    /* Multiple merge passes in tmpdir, small buffers. */
+    xsort_test_setup( &conf, &t, 20001 );
+    conf.memory = 100 * ( sizeof( int ) + sizeof( po_d ) );
+    conf.fanin = 3;
+    conf.bufsize = 64;
+    conf.tmpdir = "/tmp";
+    TEST_ASSERT_EQUAL( 0, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.out == 20001 );
+    TEST_ASSERT_TRUE( t.sorted );
+    TEST_ASSERT_TRUE( t.live == 0 );
+    free( t.input );
+
+    /* Empty input. */
+    xsort_test_setup( &conf, &t, 0 );
+    conf.memory = 100;
+    TEST_ASSERT_EQUAL( 0, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.out == 0 );
+    free( t.input );
+}
+
+
+void test_xsort_open_runs( void )
+{
+    agxs_conf_s  conf;
+    xsort_test_s t;
+    int          base;
+
+    srand( 5678 );
+
+    /* 400 runs, pending runs are merged while input is read. */
+    xsort_test_setup( &conf, &t, 40000 );
+    conf.memory = 100 * ( sizeof( int ) + sizeof( po_d ) );
+    conf.fanin = 4;
+    conf.bufsize = 64;
+    base = xsort_test_fds();
+    t.max_fds = 0;
+    TEST_ASSERT_EQUAL( 0, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.out == 40000 );
+    TEST_ASSERT_TRUE( t.sorted );
+    TEST_ASSERT_TRUE( t.live == 0 );
+
+    /* 3 pending runs per level (5 levels), plus merge streams. */
+    TEST_ASSERT_TRUE( t.max_fds - base <= 3 * 5 + 2 * ( 4 + 1 ) );
+    TEST_ASSERT_EQUAL( base, xsort_test_fds() );
+    free( t.input );
+}
+
+
+void test_xsort_errors( void )
+{
+    agxs_conf_s  conf;
+    xsort_test_s t;
+
+    srand( 4321 );
+
+    /* Serializer failure: error, and no items are leaked. */
+    xsort_test_setup( &conf, &t, 5000 );
+    conf.memory = 100 * ( sizeof( int ) + sizeof( po_d ) );
+    conf.fanin = 4;
+    t.fail_write = 1;
+    TEST_ASSERT_EQUAL( -1, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.live == 0 );
+    free( t.input );
+
+    /* Bad tmpdir. */
+    xsort_test_setup( &conf, &t, 5000 );
+    conf.memory = 100 * ( sizeof( int ) + sizeof( po_d ) );
+    conf.tmpdir = "/nonexistent/dir";
+    TEST_ASSERT_EQUAL( -1, agxs_sort( &conf ) );
+    TEST_ASSERT_TRUE( t.live == 0 );
+    free( t.input );
+}